@@ -0,0 +1,61 @@
+// BMS_Config.h
+// ------------
+// Function declarations for applying a whole BMS configuration as one transaction.
+// A configuration is a fixed list of settings, each a named command from the register table and its
+// arguments, encoded into a register image. Applying it reads back the registers the image covers,
+// writes only those that differ, all within a single conversion-off window, then reads them back
+// again to verify before turning conversions on.
+//
+// Registers from 0x21 up (the diagnostic enables) share their bits with latched fault flags, so what
+// reads back is not what was written. They are always written and never compared.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef BMS_CONFIG_H
+#define BMS_CONFIG_H
+
+#include <Arduino.h>
+#include "BMS_Registers.h" // Register descriptors and encoding
+
+#define BMS_CONFIG_MAX_REGISTERS 32
+
+// One line of a configuration, arguments as the string command functions take them
+struct BmsConfigSetting {
+    BmsRegisterId id;
+    const char* arg1;
+    const char* arg2;
+};
+
+// Encoded configuration, in ascending register order
+struct BmsConfigImage {
+    uint8_t count;
+    uint8_t address[BMS_CONFIG_MAX_REGISTERS];
+    uint16_t value[BMS_CONFIG_MAX_REGISTERS];
+    uint16_t compareMask[BMS_CONFIG_MAX_REGISTERS]; // bits that read back as written, 0 if none do
+};
+
+struct BmsConfigResult {
+    uint8_t registers;       // in the image
+    uint8_t differing;       // read back different from the image, or not comparable
+    uint8_t writeFailures;
+    uint8_t verifyFailures;  // still different after writing
+    I2C_Status status;       // first bus error, I2C_OK if every read and write went through
+    uint32_t durationMicros; // conversions off to conversions on
+    bool verified;
+};
+
+// Encodes the settings into an image, returns false if one is invalid or the image is full
+bool buildBMSConfigImage(const BmsConfigSetting* settings, uint8_t count, BmsConfigImage& image);
+
+// Reads the registers of the image from the device into words, in image order. Returns the number
+// of comparable registers that differ, registers with a compare mask of 0 are not counted.
+uint8_t compareBMSConfigImage(const BmsConfigImage& image, uint16_t* words, I2C_Status& status);
+
+// Applies the image as one transaction and leaves conversions on
+BmsConfigResult applyBMSConfigImage(const BmsConfigImage& image);
+
+#endif
@@ -14,6 +14,7 @@
 
 #include <Arduino.h>
 #include <Wire.h> // Include the Wire library for I2C communication
+#include "I2C_Queue.h" // Background I2C transaction queue
 
 extern int bmsConversionActive;
 
@@ -29,13 +30,34 @@ extern const float VNTC_RES;
 
 extern volatile bool bmsDataReady;
 extern volatile unsigned long bmsDataTimestamp;
+extern uint32_t validWindow; // microseconds after RDY that the measurement registers hold still
 
 extern uint32_t currentFilterInt;
 
 // simple basic forms of functions.
-uint16_t readBMSData(uint8_t chipAddress, uint8_t registerAddress);
+uint16_t readBMSData(uint8_t chipAddress, uint8_t registerAddress); // 0 if the read failed
+// The same read with the typed result of the transfer, data is only written on I2C_OK
+I2C_Status readBMSRegister(uint8_t chipAddress, uint8_t registerAddress, uint16_t& data);
 void writeBMSData(uint8_t chipAddress, uint8_t registerAddress, uint16_t data);
 
+// Queues a register read on Wire1 without waiting, so it runs alongside motor traffic on Wire.
+// Returns the ticket of the job, the callback (called from the I2C interrupt) may be null.
+uint32_t readBMSDataAsync(uint8_t chipAddress, uint8_t registerAddress, I2C_Callback callback = nullptr, void* context = nullptr);
+// Register value read by a completed readBMSDataAsync() job
+uint16_t getBMSDataFromJob(const I2C_Job& job);
+
+// Set to 1 once the L9961 has been checked to step through the registers on a multi-word read.
+// readBMSBlock() then reads a range in one transaction, otherwise each register is its own job,
+// all queued back to back so the bus never waits on the caller between them.
+#ifndef L9961_AUTO_INCREMENT
+#define L9961_AUTO_INCREMENT 0
+#endif
+#define BMS_BLOCK_MAX_WORDS (I2C_JOB_MAX_DATA / 2) // registers one auto-increment read can hold
+
+// Reads count consecutive registers starting at firstRegister into words. Registers that could not
+// be read are left at 0 and the status of the first failure is returned.
+I2C_Status readBMSBlock(uint8_t chipAddress, uint8_t firstRegister, uint16_t* words, uint8_t count);
+
 //commands that use chars for the command name.
 void setBMSConversionState(const char* state);
 void onBMSReadyRise(); // Interrupt Service Routine for RDY positive edge
@@ -0,0 +1,81 @@
+// BMS_NVM.h
+// ---------
+// Function declarations for booting the BMS from its NVM and for guarding NVM commits.
+// A fast boot asks the L9961 to upload its NVM into the I2C registers (NVM_2_UL), waits out the
+// upload, then checks the registers against the expected configuration image. The NVM is only
+// trusted if the last commit recorded in EEPROM was of that same image, since after an MCU-only
+// reset the registers can still match from a previous full write the NVM never held. Otherwise
+// the full configuration is written.
+//
+// The L9961 allows only 32 NVM commits (NVM_2_DL) in its lifetime. Every commit is counted in
+// EEPROM before it is issued, and commits are refused once the budget is spent or the count
+// cannot be trusted.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef BMS_NVM_H
+#define BMS_NVM_H
+
+#include <Arduino.h>
+#include "BMS_Config.h" // Configuration images
+
+#define BMS_NVM_COMMIT_LIMIT 32         // commits the device allows
+#define BMS_NVM_PRIOR_COMMITS 0         // commits made to this device before the counter existed, if known
+#define BMS_NVM_UPLOAD_US 100000        // fixed wait after NVM_2_UL, the device has no upload done flag
+
+#define BMS_NVM_BUDGET_MAGIC 0x4D564E42UL // "BNVM"
+#define BMS_NVM_BUDGET_VERSION 2 // version 1 had no fingerprintValid, its count is carried over on load
+
+// Record as stored in EEPROM
+struct BmsNvmBudgetRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t commits;     // NVM_2_DL commands issued, including BMS_NVM_PRIOR_COMMITS
+    uint16_t fingerprint; // of the image last committed, only meaningful if fingerprintValid
+    uint8_t fingerprintValid; // 1 if the last commit was of a known image, any CRC including 0 is a fingerprint
+    uint8_t reserved;
+    uint16_t crc;         // CRC-16/CCITT over all the fields above
+};
+
+struct BmsFastBootResult {
+    bool loadedFromNvm;        // the NVM image matched and nothing was written
+    bool identityValid;        // no identity register read back as 0x0000
+    uint8_t differing;         // comparable registers that did not match the image
+    uint16_t expectedFingerprint;  // of the image
+    uint16_t committedFingerprint; // of the last commit recorded in EEPROM
+    bool committedFingerprintValid; // false if no commit of a known image was recorded
+    uint32_t uploadMicros;     // NVM_2_UL to the registers being read back
+    uint32_t durationMicros;   // the whole boot, including the fallback
+    BmsConfigResult fallback;  // the full configuration, if it was needed
+};
+
+// Fingerprint of an image, CRC-16/CCITT over the address and compared bits of each register.
+// With words given the fingerprint is of those values read back instead of the image's own.
+uint16_t bmsConfigFingerprint(const BmsConfigImage& image, const uint16_t* words = nullptr);
+
+// Loads the BMS configuration from NVM, falling back to applyBMSConfigImage() on a mismatch.
+// Leaves conversions on.
+BmsFastBootResult bmsFastBoot(const BmsConfigImage& image);
+
+// Counts an NVM commit against the budget. Returns false, counting nothing, if the budget is spent
+// or the record is corrupt. Called by RWBMSNVM() before every NVM_2_DL, where the registers being
+// committed are not known, so the recorded fingerprint is cleared.
+bool takeBMSNvmCommit();
+// The same for a commit of a known image, recording its fingerprint
+bool takeBMSNvmCommit(uint16_t fingerprint);
+
+// Commits left, 0 if the record is corrupt
+uint8_t getBMSNvmCommitsRemaining();
+
+// Fingerprint of the image last committed. Returns false if it is unknown or the record is corrupt.
+bool getBMSNvmFingerprint(uint16_t& fingerprint);
+
+// Commits the device's registers to NVM, if they match the image and the budget allows.
+// Leaves conversions as they were.
+bool commitBMSConfigToNVM(const BmsConfigImage& image);
+
+#endif
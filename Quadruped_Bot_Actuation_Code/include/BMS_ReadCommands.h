@@ -17,6 +17,8 @@
 #include "Arduino.h"
 #include "BMS_CoreCommands.h"
 
+// The measurement readers return NAN if the L9961 did not answer
+
 // Read individual cell voltages
 float readVCell1();
 float readVCell2();
@@ -45,16 +47,58 @@ struct CoulombCountResult {
     uint8_t sampleCount;
     float totalCoulombs;    // Total coulombs counted (global)
     unsigned long totalSampleCount; // Total sample count (global)
+    I2C_Status status;      // totals are left alone unless I2C_OK
 };
 
 // Read coulomb counter (returns struct)
 CoulombCountResult readCoulombCounter();
 
-// Manufacturer data reads
-uint32_t readManufacturerName();
-uint16_t readManufacturerDate();
-uint16_t readFirstUsageDate();
-uint32_t readSerialNumber();
-uint32_t readDeviceName();
+// The measurement block, 0x21 (VCELL1_MEAS) to 0x2E (CC_ACC_LSB_CNTR)
+#define BMS_MEASUREMENT_FIRST_REGISTER 0x21
+#define BMS_MEASUREMENT_LAST_REGISTER 0x2E
+#define BMS_MEASUREMENT_COUNT (BMS_MEASUREMENT_LAST_REGISTER - BMS_MEASUREMENT_FIRST_REGISTER + 1)
+#define BMS_CELL_COUNT 5
+
+struct BmsMeasurements {
+    uint16_t raw[BMS_MEASUREMENT_COUNT]; // register values, raw[0] is 0x21
+
+    float cellVoltage[BMS_CELL_COUNT]; // volts, same scaling as readVCell1()..readVCell5()
+    float cellSum;        // volts
+    float batteryVoltage; // volts
+    float ntcVoltage;     // volts
+    float dieTemperature; // degrees C
+    float current;        // amps, signed
+    uint16_t diagOvOtUt;  // DIAG_OV_OT_UT (0x2A)
+    uint16_t diagUv;      // DIAG_UV (0x2B)
+    int32_t coulombAccumulator; // 24 bit signed accumulator, left running
+    uint8_t coulombSamples;
+};
+
+// Decodes the raw words of a measurement block in one pass
+void decodeBMSMeasurements(BmsMeasurements& measurements);
+
+// Reads the whole measurement block with readBMSBlock() and decodes it
+I2C_Status readBMSMeasurements(BmsMeasurements& measurements);
+
+// Bus time of one reading of the cells, sum, VB, NTC, die temperature and current, in microseconds.
+// Compares the separate read functions, one blocking transaction each, against a block read of
+// 0x21 to 0x2C. The RDY snapshots share Wire1, so run it with conversions off for clean numbers.
+struct BmsBlockBenchmark {
+    uint16_t iterations;
+    uint8_t separateTransactions; // per reading
+    uint8_t blockTransactions;
+    uint32_t separateMicros;      // mean per reading
+    uint32_t blockMicros;
+    uint32_t decodeMicros;        // mean of decodeBMSMeasurements() on its own
+};
+
+BmsBlockBenchmark benchmarkBMSBlockRead(uint8_t chipAddress, uint16_t iterations);
+
+// Manufacturer data reads, 0 if the read failed, pass status to tell that apart from a real 0
+uint32_t readManufacturerName(I2C_Status* status = nullptr);
+uint16_t readManufacturerDate(I2C_Status* status = nullptr);
+uint16_t readFirstUsageDate(I2C_Status* status = nullptr);
+uint32_t readSerialNumber(I2C_Status* status = nullptr);
+uint32_t readDeviceName(I2C_Status* status = nullptr);
 
 #endif // BMS_READCOMMANDS_H
\ No newline at end of file
@@ -0,0 +1,146 @@
+// BMS_Registers.h
+// ---------------
+// Register descriptor table for the writable L9961 BMS registers and the named commands built on them.
+// Each entry gives the register address, the command group it belongs to and up to two fields
+// (position, width, unit, min, max, default), so every threshold register shares one encode path.
+// Command names are looked up through a switch on their FNV-1a hash, which the compiler turns into
+// a jump table or binary search, and a duplicate hash fails to compile.
+//
+// The string command functions in BMS_SetupCommands.h and BMS_NumericalCommands.h are thin wrappers
+// over findBMSRegister() and encodeBMSCommand().
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef BMS_REGISTERS_H
+#define BMS_REGISTERS_H
+
+#include <Arduino.h>
+#include "BMS_CoreCommands.h"
+
+#define BMS_MAX_FIELDS 2
+
+// Every named command, in table order
+enum BmsRegisterId : uint8_t {
+    // Configuration, written as a binary string or "default"
+    BMS_CFG2_ENABLES,
+    BMS_TO_PRDV_BAL_MSK,
+    BMS_TO_FUSE_RST_MSK,
+    BMS_TO_FAULTN_MSK,
+    BMS_CURR_MSK,
+    BMS_DIAG_OV_OT_UT,
+    BMS_DIAG_UV,
+    BMS_DIAG_CURR,
+    // Identity, any value but 0x0000
+    BMS_MANUFACTURE_NAME_MSB,
+    BMS_MANUFACTURE_NAME_LSB,
+    BMS_MANUFACTURING_DATE,
+    BMS_FIRST_USAGE_DATE,
+    BMS_SERIAL_NUMBER_MSB,
+    BMS_SERIAL_NUMBER_LSB,
+    BMS_DEVICE_NAME_MSB,
+    BMS_DEVICE_NAME_LSB,
+    // Thresholds and calibration, written in real units
+    BMS_CSA_GAIN_FACTOR,
+    BMS_VCELL_OV_TH,
+    BMS_VCELL_UV_TH,
+    BMS_VCELL_SEVERE_DELTA_THRS,
+    BMS_VCELL_BAL_UV_DELTA_TH,
+    BMS_VB_OV_TH,
+    BMS_VB_UV_TH,
+    BMS_VB_SUM_MAX_DIFF_TH,
+    BMS_VNTC_OT_TH,
+    BMS_VNTC_UT_TH,
+    BMS_VNTC_SEVERE_OT_DELTA_TH,
+    BMS_OVC_THRESHOLDS,
+    BMS_PERSISTENT_OVC_THRESHOLDS,
+    BMS_SC_THRESHOLD,
+    // Real time commands, a fixed value
+    BMS_BAL_ENABLE,
+    BMS_BAL_DISABLE,
+    BMS_GO2SHIP,
+    BMS_GO2STBY,
+    BMS_FUSE_TRIG_DISARM,
+    BMS_FUSE_TRIG_ARM,
+    BMS_FUSE_TRIG_FIRE_INTERRUPT,
+    BMS_FUSE_TRIG_FIRE,
+    // NVM transfers, a fixed value
+    BMS_NVM_2_DL,
+    BMS_NVM_2_UL,
+    BMS_REGISTER_COUNT
+};
+
+enum BmsCommandGroup : uint8_t {
+    BMS_GROUP_CONFIG,
+    BMS_GROUP_IDENTITY,
+    BMS_GROUP_NUMERICAL,
+    BMS_GROUP_REALTIME,
+    BMS_GROUP_NVM
+};
+
+// How an argument becomes the code in a field
+enum BmsUnit : uint8_t {
+    BMS_UNIT_RAW,   // integer, written as it is
+    BMS_UNIT_COUNT, // integer filter count
+    BMS_UNIT_VCELL, // volts, 16 * VCELL_RES per step
+    BMS_UNIT_VB,    // volts, 16 * VB_RES per step
+    BMS_UNIT_VNTC,  // volts, VNTC_RES per step
+    BMS_UNIT_IMAX,  // amps, 255 steps up to Imax. Min, max and default are fractions of Imax.
+    BMS_UNIT_SC     // amps, short circuit comparator steps of 14.04mV from 49.14mV across the sense resistor
+};
+
+struct BmsField {
+    uint8_t shift;
+    uint8_t width;
+    BmsUnit unit;
+    float min;          // arguments are clamped to min and max before encoding
+    float max;
+    float defaultValue; // used for "default"
+};
+
+struct BmsRegisterDescriptor {
+    BmsRegisterId id;
+    const char* name;
+    uint8_t address;
+    BmsCommandGroup group;
+    uint8_t fieldCount; // 0 for the fixed value commands, which write fields[0].defaultValue
+    BmsField fields[BMS_MAX_FIELDS];
+};
+
+enum BmsEncodeStatus : uint8_t {
+    BMS_ENCODE_OK,
+    BMS_ENCODE_CAPPED,   // a configuration value above the register's maximum was capped
+    BMS_ENCODE_INVALID   // unknown command, or a value the group does not accept
+};
+
+// Descriptor of a command name, nullptr if there is none
+const BmsRegisterDescriptor* findBMSRegister(const char* name);
+const BmsRegisterDescriptor& getBMSRegister(BmsRegisterId id);
+
+// Encodes the arguments of a command into its register value. arg1 goes to the first field and
+// arg2 to the second. Numerical arguments take a number, "min", "max" or "default", configuration
+// takes "0b..." or "default", identity takes a number in any base strtol() accepts.
+BmsEncodeStatus encodeBMSCommand(const BmsRegisterDescriptor& reg, const char* arg1, const char* arg2, uint16_t& data);
+
+// Bits of the register covered by the descriptor's fields, the whole register for configuration
+// and identity, 0 for the fixed value commands
+uint16_t getBMSWritableMask(const BmsRegisterDescriptor& reg);
+
+// Writes a register value with conversions turned off first if they are running
+void writeBMSRegister(const BmsRegisterDescriptor& reg, uint16_t data);
+
+// Runs every command of a golden table through the table-driven path and compares the address and
+// value against those the strcmp-based command functions produced, without touching the bus.
+struct BmsEncodingTest {
+    uint16_t cases;
+    uint16_t mismatches;
+    int16_t firstMismatch; // index of the first failing case, -1 if none
+    bool passed;
+};
+
+BmsEncodingTest testBMSRegisterEncodings();
+
+#endif
@@ -0,0 +1,59 @@
+// BMS_Snapshot.h
+// --------------
+// Function declarations for RDY-driven acquisition of the L9961 measurements.
+// Each rising edge of RDY starts a read of the whole measurement block (0x21-0x2E) on Wire1 in the
+// background. Once the last register has landed the block is decoded and published as a snapshot
+// that readers copy without touching the bus. With L9961_AUTO_INCREMENT the block is a single read.
+//
+// The measurements only hold still for validWindow microseconds after RDY, after that the next
+// conversion starts overwriting them. A block that finished late, or that was still being read when
+// the next RDY edge came, may mix two conversions. It is still published but flagged, and counted.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef BMS_SNAPSHOT_H
+#define BMS_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "BMS_CoreCommands.h" // Register access and the valid window
+#include "BMS_ReadCommands.h" // Measurement block layout and decoding
+
+struct BmsSnapshot {
+    BmsMeasurements measurements;
+
+    uint32_t readyTime;   // micros() at the RDY edge the block was read for
+    uint32_t readMicros;  // from the RDY edge to the last register landing
+    uint32_t sequence;    // increments once per published snapshot, 0 means no data yet
+    bool inWindow;        // every register landed inside the valid window of one conversion
+};
+
+struct BmsSnapshotStats {
+    uint32_t published;
+    uint32_t missedWindow; // published but flagged, read late or overlapping the next RDY edge
+    uint32_t failed;       // a register read failed or the queue was full, nothing published
+    uint32_t lastReadMicros;
+    uint32_t maxReadMicros;
+};
+
+// Attaches the RDY interrupt and starts acquiring from the BMS at chipAddress.
+// Replaces attaching onBMSReadyRise() directly, which is still called on each edge.
+void bmsSnapshotBegin(uint8_t chipAddress);
+
+// Copies the latest published snapshot. Never touches the bus, returns false if nothing has been
+// published yet or the snapshot was republished twice during the copy.
+bool getBMSSnapshot(BmsSnapshot& snapshot);
+
+// Sequence number of the latest published snapshot, cheap to poll for new data
+uint32_t getBMSSnapshotSequence();
+
+// Microseconds since the RDY edge of the latest published snapshot
+uint32_t getBMSSnapshotAge();
+
+BmsSnapshotStats getBMSSnapshotStats();
+void resetBMSSnapshotStats();
+
+#endif
@@ -0,0 +1,18 @@
+// EEPROM_Map.h
+// ------------
+// Layout of the records kept in the Teensy EEPROM (emulated in flash).
+// Every record that is stored in EEPROM gets its start address here so records cannot overlap.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef EEPROM_MAP_H
+#define EEPROM_MAP_H
+
+#define EEPROM_ENCODER_OFFSETS_ADDRESS 0 // EncoderOffsetRecord, see NCDR_OffsetStore.h (64 bytes reserved)
+#define EEPROM_BMS_NVM_BUDGET_ADDRESS 64 // BmsNvmBudgetRecord, see BMS_NVM.h (16 bytes reserved)
+
+#endif
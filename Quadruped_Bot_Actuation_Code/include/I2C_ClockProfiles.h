@@ -0,0 +1,46 @@
+// I2C_ClockProfiles.h
+// --------------------
+// Function declarations for running the two I2C buses side by side.
+// Wire (motor drivers and multiplexer) and Wire1 (BMS) each have their own transaction queue and
+// interrupt, so traffic on one bus never waits for the other. This layer sets the clock profile of
+// each bus and measures how much the two buses overlap. It does not reorder jobs, both queues stay
+// strictly in order.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef I2C_CLOCKPROFILES_H
+#define I2C_CLOCKPROFILES_H
+
+#include <Arduino.h>
+#include "I2C_Queue.h" // Transaction queues of both buses
+
+// Clock profiles
+#define I2C_CLOCK_STANDARD 100000   // 100kHz
+#define I2C_CLOCK_FAST 400000       // 400kHz
+#define I2C_CLOCK_FAST_PLUS 1000000 // 1MHz
+
+// Fastest profile the devices on each bus support. The PCA9548A and LP3943 are fast mode parts,
+// Wire1 only carries the L9961.
+#define I2C_WIRE_MAX_CLOCK I2C_CLOCK_FAST
+#define I2C_WIRE1_MAX_CLOCK I2C_CLOCK_FAST_PLUS
+
+// Sets the clock profile of a bus. Returns false, leaving the clock unchanged, if the profile is not
+// one of the above or is faster than the devices on the bus allow.
+bool I2C_SetClockProfile(uint8_t bus, uint32_t clockHz);
+uint32_t I2C_GetClockProfile(uint8_t bus);
+
+// Time for a set of BMS register reads on Wire1 and LP3943 register reads on Wire, run one after
+// the other and then with both buses queued at once, in microseconds
+struct I2C_OverlapBenchmark {
+    uint16_t iterations;
+    uint32_t serialMicros;
+    uint32_t concurrentMicros;
+};
+
+I2C_OverlapBenchmark benchmarkBusOverlap(uint16_t iterations, uint8_t bmsAddress, uint8_t driverAddress);
+
+#endif
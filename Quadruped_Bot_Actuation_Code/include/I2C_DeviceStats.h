@@ -0,0 +1,52 @@
+// I2C_DeviceStats.h
+// -----------------
+// Function declarations for the per-device I2C statistics.
+// Every job completed by the transaction queue is recorded against its device: transaction and error
+// counts, min/mean/max time on the bus and a latency histogram. Devices behind the PCA9548A share an
+// address, so they are told apart by the multiplexer channels that were open at the time.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef I2C_DEVICESTATS_H
+#define I2C_DEVICESTATS_H
+
+#include <Arduino.h>
+#include "I2C_Queue.h" // I2C_Status
+
+// Devices tracked: 64 drivers (8 addresses on 8 channels), a multicast channel mask for each address,
+// the mux, the BMS and some spare. Driver discovery alone probes all 64.
+#define I2C_DEVICE_STATS_MAX (64 + 8 + 2 + 22)
+#define I2C_LATENCY_BUCKETS 8   // bucket n counts latencies below I2C_LATENCY_BUCKET_BASE_US << n, the last one the rest
+#define I2C_LATENCY_BUCKET_BASE_US 64
+
+struct I2C_DeviceStats {
+    uint8_t bus;
+    uint8_t address;
+    uint8_t muxMask;        // multiplexer channels open during the access, 0 off the multiplexer
+    uint32_t transactions;
+    uint32_t errors;        // all failures, timeouts included
+    uint32_t timeouts;
+    uint32_t minLatency;    // time on the bus in microseconds
+    uint32_t meanLatency;
+    uint32_t maxLatency;
+    uint32_t histogram[I2C_LATENCY_BUCKETS];
+};
+
+// Records one completed job, called from the queue interrupt
+void I2C_RecordTransaction(uint8_t bus, uint8_t address, uint8_t muxMask, I2C_Status status, uint32_t latency);
+
+// Devices seen since the last reset, in the order they were first seen
+uint8_t I2C_GetDeviceCount();
+// Transactions not recorded since the last reset because the table was full
+uint32_t I2C_GetDroppedDeviceRecords();
+bool I2C_GetDeviceStats(uint8_t index, I2C_DeviceStats& stats);
+void I2C_ResetDeviceStats();
+
+// Upper limit of a histogram bucket in microseconds, 0 for the open-ended last bucket
+uint32_t I2C_GetLatencyBucketLimit(uint8_t bucket);
+
+#endif
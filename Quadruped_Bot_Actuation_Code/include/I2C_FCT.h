@@ -15,6 +15,10 @@
 
 #include <Arduino.h>
 #include <Wire.h> // Include the Wire library for I2C communication
+#include "I2C_Queue.h" // I2C_Status
+
+// Writes are queued on the background transaction queue and return straight away, reads wait for their result.
+// Jobs on a bus run in order, so a queued write always lands before a later read on the same bus.
 
 // Function declarations
 
@@ -31,6 +35,11 @@ unsigned char I2C_RD(unsigned char ADDRESS);
 // Overloaded function for devices with chip address and register address
 unsigned char I2C_RD(unsigned char chipAddress, unsigned char registerAddress);
 
+// The reads above return 0 when the device does not answer. These return the typed result of the
+// transfer instead, so a failed read cannot pass for a register holding 0. data is only written on I2C_OK.
+I2C_Status I2C_ReadByte(uint8_t bus, uint8_t chipAddress, uint8_t& data);
+I2C_Status I2C_ReadRegister(uint8_t bus, uint8_t chipAddress, uint8_t registerAddress, uint8_t& data);
+
 //WIRE1 functions
 // Function to write to a specific I2C address on the second I2C channel
 
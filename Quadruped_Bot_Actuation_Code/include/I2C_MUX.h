@@ -3,6 +3,11 @@
 // Function declarations for controlling the PCA9548A I2C multiplexer.
 // Includes functions to select a single channel or disable all channels on the multiplexer.
 //
+// The driver keeps the state of every multiplexer on Wire (addresses 0x70 to 0x77), both the channels
+// callers asked for and what the chip is known to hold. A selection the chip already holds costs
+// nothing, and a failed control byte write marks the chip state unknown so the next selection goes out.
+// Selections are silent, tracing can be compiled in with I2C_MUX_TRACE.
+//
 // Author: Greg Moxon
 // Organisation: Moxon Electronics
 // Created: 2024-05-16
@@ -20,10 +25,37 @@
 
 #define I2C_MUX_ADDRESS 0x70 // I2C address of the PCA9548A multiplexer
 
+#define I2C_MUX_BASE_ADDRESS 0x70 // A2-A0 select one of eight addresses from here
+#define I2C_MUX_MAX_COUNT 8
+
+#define I2C_MUX_ALL_CHANNELS 0xFF
+
+// Set to 1 to print every control byte written or skipped on the serial link
+#ifndef I2C_MUX_TRACE
+#define I2C_MUX_TRACE 0
+#endif
+
 // Function to select a single channel on the PCA9548A I2C multiplexer
 void I2C_SelectChannel(uint8_t muxAddress, uint8_t channel);
 
 // Function to disable all channels on the PCA9548A I2C multiplexer
 void I2C_DisableAllChannels(uint8_t muxAddress);
 
-#endif
\ No newline at end of file
+// Function to enable several channels at once, bit n of the mask enables channel n.
+// A write sent while several channels are enabled reaches every selected device (multicast).
+void I2C_SelectChannelMask(uint8_t muxAddress, uint8_t channelMask);
+
+// Channels last selected on a multiplexer, 0 after I2C_DisableAllChannels()
+uint8_t I2C_GetChannelMask(uint8_t muxAddress);
+
+// Call after pulsing NRESET, every multiplexer on the line is back to all channels off
+void I2C_MuxResetAll();
+
+// Call when a multiplexer may not hold what was last written, such as after a bus recovery
+// without a reset. The next selection is written even if it matches.
+void I2C_MuxInvalidate(uint8_t muxAddress);
+
+// Writes the channels last selected to a multiplexer if it is not known to hold them
+void I2C_MuxResync(uint8_t muxAddress);
+
+#endif
@@ -0,0 +1,174 @@
+// I2C_Queue.h
+// -----------
+// Function declarations for the interrupt-driven I2C transaction queue.
+// Each bus (Wire on LPI2C1, Wire1 on LPI2C3) has a ring of jobs that is worked through in the
+// background by the LPI2C interrupt, feeding the command FIFO and draining the receive FIFO.
+// A job is a write, a read, or a write followed by a read, so register accesses are a single job.
+// Jobs on the same bus always run in the order they were queued.
+//
+// Callers get a ticket for each job. A ticket can be polled or waited on, and an optional callback
+// is called from the interrupt when the job completes. The result of a job stays readable until
+// its slot in the ring is reused, I2C_QUEUE_LENGTH jobs later.
+//
+// Every job has a timeout. A job that overruns it is aborted by the next caller that waits on the
+// bus, resetting the peripheral, so a missing or stuck device can never hang the caller. The
+// callback of an aborted job is called from that caller with interrupts masked.
+//
+// Once I2C_QueueBegin() has been called the Wire and Wire1 objects must not be used directly,
+// they are only used to set up the pins and bus clock.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <Arduino.h>
+
+#define I2C_BUS_WIRE 0  // pins 18(sda) and 19(scl), motor drivers and multiplexer
+#define I2C_BUS_WIRE1 1 // pins 17(sda1) and 16(scl1), BMS
+#define I2C_BUS_COUNT 2
+
+#define I2C_QUEUE_LENGTH 16 // jobs per bus
+#define I2C_JOB_MAX_DATA 32 // bytes written or read by one job
+
+// Job flags
+#define I2C_FLAG_STOP_BEFORE_READ 0x01 // end the write with a STOP instead of a repeated START
+
+// Jobs are given twice their bus time at the current clock plus this margin to finish
+#define I2C_TIMEOUT_MARGIN_US 200
+// Attempts after the first made by I2C_Transfer()
+#define I2C_RETRY_LIMIT 2
+
+// Result of a job or transfer
+enum I2C_Status : uint8_t {
+    I2C_OK,
+    I2C_ERROR_NACK,        // address or data byte not acknowledged
+    I2C_ERROR_ARBITRATION, // arbitration lost, another master or noise on the bus
+    I2C_ERROR_BUS,         // FIFO error or pin low timeout
+    I2C_ERROR_TIMEOUT,     // the job overran its timeout and the peripheral was reset
+    I2C_ERROR_QUEUE_FULL,  // no free slot in the ring
+    I2C_ERROR_EXPIRED,     // the ticket's slot has been reused
+    I2C_ERROR_INVALID      // bad bus number or lengths
+};
+
+enum I2C_JobState : uint8_t {
+    I2C_JOB_FREE,    // slot never used
+    I2C_JOB_QUEUED,
+    I2C_JOB_ACTIVE,
+    I2C_JOB_DONE,
+    I2C_JOB_FAILED,  // address or data not acknowledged, or the bus was lost
+    I2C_JOB_EXPIRED  // returned for tickets whose slot has been reused
+};
+
+struct I2C_Job;
+typedef void (*I2C_Callback)(const I2C_Job& job);
+
+struct I2C_Job {
+    uint32_t ticket;
+    uint8_t address;
+    uint8_t flags;
+    uint8_t txLength;   // bytes written first, usually the register address then data
+    uint8_t rxLength;   // bytes read afterwards, 0 for a plain write
+    uint8_t txData[I2C_JOB_MAX_DATA];
+    uint8_t rxData[I2C_JOB_MAX_DATA];
+    I2C_Callback callback; // called from the interrupt when the job completes, may be null
+    void* context;         // passed through to the callback
+    uint32_t timeoutMicros; // time allowed on the bus before the job is aborted
+    volatile I2C_JobState state;
+    volatile I2C_Status status;
+};
+
+// Takes over both LPI2C peripherals after Wire.begin() and Wire1.begin()
+void I2C_QueueBegin();
+
+// Queues a job. Returns its ticket, or 0 if the ring is full or the lengths are invalid.
+// A timeout of 0 sizes the timeout from the job length and the bus clock.
+// Safe to call from interrupts, including job callbacks. The ring is updated with every interrupt
+// masked, so an interrupt can queue jobs on a bus while the main loop is queuing on it too. Such an
+// interrupt must not have a higher priority than the bus interrupts (128), which are not masked.
+uint32_t I2C_Enqueue(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength, uint8_t rxLength,
+                     I2C_Callback callback = nullptr, void* context = nullptr, uint8_t flags = 0,
+                     uint32_t timeoutMicros = 0);
+
+// Same as I2C_Enqueue() but waits for a free slot if the ring is full, aborting a stalled job if needed.
+// Returns 0 only for invalid lengths. Must not be called from the bus interrupt or a job callback.
+uint32_t I2C_EnqueueWaiting(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength, uint8_t rxLength,
+                            I2C_Callback callback = nullptr, void* context = nullptr, uint8_t flags = 0);
+
+// Queues a register write of one byte, waiting for a free slot if the ring is full
+uint32_t I2C_WriteAsync(uint8_t bus, uint8_t address, uint8_t registerAddress, uint8_t dataByte,
+                        I2C_Callback callback = nullptr, void* context = nullptr);
+
+// State of a job, I2C_JOB_EXPIRED once its slot has been reused
+I2C_JobState I2C_JobStatus(uint8_t bus, uint32_t ticket);
+
+// Blocks until a job completes and copies out the bytes it read. Jobs that overrun their timeout are
+// aborted while waiting, so this never blocks longer than the timeouts of the jobs queued ahead.
+// Must not be called from the bus interrupt or a job callback.
+I2C_Status I2C_Wait(uint8_t bus, uint32_t ticket, uint8_t* rxData = nullptr);
+
+// Queues a job and waits for it, retrying up to I2C_RETRY_LIMIT times on bus errors and timeouts.
+// The worst case is bounded by (I2C_RETRY_LIMIT + 1) times the timeouts of the job and those queued ahead of it.
+I2C_Status I2C_Transfer(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength,
+                        uint8_t* rxData, uint8_t rxLength, uint8_t flags = 0);
+
+// Readable name of a status, for the serial link
+const char* I2C_StatusName(I2C_Status status);
+
+// Blocks until every queued job on a bus has completed or timed out
+void I2C_WaitIdle(uint8_t bus);
+
+// True when a bus has no job queued or running
+bool I2C_Idle(uint8_t bus);
+
+// Changes the clock of a bus between jobs, waiting for the bus to go idle first.
+// Must not be called from the bus interrupt or a job callback.
+void I2C_SetClock(uint8_t bus, uint32_t clockHz);
+
+// Recovery support. A failed job with a timeout, bus error or lost arbitration flags the bus as
+// needing recovery, as does an idle bus that stays busy because SDA is held low.
+// While a bus is suspended nothing new is started on it, queued jobs wait.
+bool I2C_RecoveryNeeded(uint8_t bus);
+bool I2C_BusHeld(uint8_t bus);     // the master is idle but sees the bus busy
+void I2C_RequestRecovery(uint8_t bus);
+void I2C_ClearRecoveryRequest(uint8_t bus); // the bus was found free, the failure that flagged it was transient
+void I2C_SuspendBus(uint8_t bus);  // aborts the job on the bus, if any
+void I2C_ResumeBus(uint8_t bus);   // re-initialises the peripheral and pins, clears the recovery flag
+
+// Called by I2C_Transfer() before retrying after a timeout, bus error or lost arbitration.
+// Runs in the caller's context, never from an interrupt.
+typedef void (*I2C_RecoveryHandler)(uint8_t bus);
+void I2C_SetRecoveryHandler(I2C_RecoveryHandler handler);
+
+// Dry run, for benchmarking the code that schedules jobs. Jobs queued on the bus complete on the spot
+// as if every device had acknowledged them, reads return zeros and nothing reaches the pins.
+// Callbacks are called from the caller that queued the job. Enabling waits for the bus to go idle.
+struct I2C_DryRunStats {
+    uint32_t jobs;
+    uint32_t muxWrites; // multiplexer control bytes among them
+    uint32_t bits;      // the jobs would have put on the wire, STARTs, ACKs and STOPs included
+};
+
+void I2C_SetDryRun(uint8_t bus, bool enabled);
+I2C_DryRunStats I2C_GetDryRunStats(uint8_t bus); // since the dry run was enabled
+bool I2C_IsDryRun(uint8_t bus); // so device state can be left alone by simulated jobs
+
+// Activity counters of a bus since the last reset
+struct I2C_BusStats {
+    uint32_t jobsCompleted;
+    uint32_t jobsFailed;
+    uint8_t queueDepth;     // jobs queued or on the bus now
+    uint8_t maxQueueDepth;  // deepest the ring has been
+    uint32_t busyMicros;    // time with a job on the bus
+    uint32_t windowMicros;  // time since the counters were reset
+    float utilisation;      // busyMicros / windowMicros
+};
+
+I2C_BusStats I2C_GetBusStats(uint8_t bus);
+void I2C_ResetBusStats(uint8_t bus);
+
+#endif
@@ -0,0 +1,75 @@
+// I2C_Recovery.h
+// --------------
+// Function declarations for recovering an I2C bus that a device has locked up.
+// A device reset or glitched in the middle of a read can hold SDA low indefinitely, and every job on
+// the bus then times out. Recovery takes the pins away from the peripheral, clocks SCL by hand until
+// the device lets go of SDA (at most nine pulses), sends a STOP and hands the pins back.
+// On Wire the PCA9548A is then reset with NRESET, the channels that were open are opened again and
+// the LP3943 drivers on them are re-initialised. Re-initialisation turns their outputs off, so the
+// register values they were last commanded are then written back and the motors carry on as before.
+//
+// Recovery only runs once the bus is seen held, busy to an idle master or with SDA or SCL low. A job
+// that failed with a timeout or bus error on a free bus is just retried, so a transient error does not
+// stop the motors.
+//
+// Jobs queued while a bus is being recovered wait and run once it is back. Writes to the drivers
+// among them land before the re-initialisation, and are part of the commanded state written back.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef I2C_RECOVERY_H
+#define I2C_RECOVERY_H
+
+#include <Arduino.h>
+#include "I2C_Queue.h" // Bus suspend and resume
+
+#define I2C_RECOVERY_MAX_PULSES 9     // a device can be at most eight data bits and an ACK into a byte
+#define I2C_RECOVERY_HALF_PERIOD_US 5 // SCL pulses at 100kHz
+
+struct I2C_RecoveryResult {
+    bool released;        // SDA was high after the clock pulses
+    uint8_t clockPulses;  // SCL pulses it took to release SDA
+    I2C_Status reinitStatus; // multiplexer and driver re-initialisation, I2C_OK on Wire1
+    uint32_t durationMicros; // from the start of recovery to the drivers being ready again
+    uint8_t driversRestored; // drivers the commanded state was written back to
+};
+
+struct I2C_RecoveryStats {
+    uint32_t recoveries;
+    uint32_t failures;     // SDA still held low, or the re-initialisation failed
+    uint32_t lastMicros;
+    uint32_t maxMicros;
+};
+
+// Installs recovery as the I2C_Transfer() retry handler. After the Wire bus has been recovered the
+// registered drivers are re-initialised, or those at driverAddress if none have been discovered.
+void I2C_RecoveryBegin(uint8_t driverAddress);
+
+// Recovers a bus straight away
+I2C_RecoveryResult I2C_RecoverBus(uint8_t bus);
+
+// Recovers any bus flagged as needing it that is held, call from the main loop. A flagged bus found
+// idle and free has its flag cleared instead. Returns true if a recovery ran.
+bool I2C_ServiceRecovery();
+
+I2C_RecoveryStats I2C_GetRecoveryStats(uint8_t bus);
+void I2C_ResetRecoveryStats();
+
+// Simulated lock-up of the Wire bus: SDA is driven low as a stuck device would and only released
+// after holdPulses clock pulses. The bus is flagged and recovered through I2C_ServiceRecovery(),
+// then the multiplexer state is read back and a driver write is timed.
+struct I2C_RecoveryTest {
+    I2C_RecoveryResult recovery;
+    bool muxRestored;          // the multiplexer control register matches the channels open before
+    I2C_Status resumeStatus;   // first driver write after recovery
+    uint32_t resumeMicros;     // from the lock-up being detected to that write landing
+    bool passed;
+};
+
+I2C_RecoveryTest I2C_TestRecovery(uint8_t holdPulses);
+
+#endif
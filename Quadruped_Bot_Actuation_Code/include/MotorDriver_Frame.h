@@ -0,0 +1,89 @@
+// MotorDriver_Frame.h
+// -------------------
+// Function declarations for batching motor commands into frames.
+// A frame collects the commands for a whole pose. Nothing reaches the bus until the frame is
+// committed, then the drivers are written in multiplexer channel order, starting from the channel
+// already selected, so each channel is switched to once. The registers of each driver go out as
+// bursts through the shadow registers, and the whole frame is queued back to back.
+//
+// Only drivers the shadow covers (addresses 0x60-0x67 on channels 0-7) can be put in a frame.
+// A direct motion command to a driver with commands in an open frame writes them along with its own.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef MOTORDRIVER_FRAME_H
+#define MOTORDRIVER_FRAME_H
+
+#include <Arduino.h>
+#include "MotorDriver_Shadow.h" // Channel count
+
+struct MotorFrameResult {
+    uint8_t drivers;         // drivers with a command in the frame
+    uint8_t bursts;          // register bursts queued, registers the drivers already held are skipped
+    uint8_t channelSwitches; // multiplexer control bytes written
+    uint32_t queueMicros;    // time taken to queue the frame
+    uint32_t landMicros;     // from the commit to the last write landing, 0 if not waited for
+};
+
+// Starts a frame, dropping any commands of an uncommitted one
+void motorFrameBegin();
+bool motorFrameIsOpen();
+
+// Same arguments as the motion commands. Return false, printing an error, if the driver is not covered.
+bool motorFrameMove(uint8_t mux_channel, uint8_t address, uint8_t speed, bool direction);
+bool motorFrameSetSpeeds(uint8_t mux_channel, uint8_t address, uint8_t speedOne, uint8_t speedTwo);
+bool motorFrameDefaultMove(uint8_t mux_channel, uint8_t address, uint8_t speedLevel, bool direction);
+bool motorFrameStop(uint8_t mux_channel, uint8_t address);
+bool motorFrameSetOutput(uint8_t mux_channel, uint8_t address, uint8_t output, uint8_t speed); // one output's duty cycle
+
+// Queues every command in the frame and closes it. Waits for the writes to land if asked to.
+MotorFrameResult motorFrameCommit(bool waitForLanding = false);
+
+// Two-phase commit for the smallest skew between drivers. The first phase writes every register but
+// LS1 (0x07), which selects what drives the motor outputs, and waits for them to land. The second
+// phase writes LS1 to all drivers back to back, one multicast for each address and value, so drivers
+// switching to the same setting switch together. Drivers whose first phase failed are not switched.
+// A multicast is acknowledged if any driver takes it, so after the switch LS1 is read back from every
+// switched driver.
+//
+// Duty cycle changes on outputs already running from PWM0 or PWM1 take effect when their first phase
+// burst lands, as both banks are in use by the two outputs and there is no spare one to stage into.
+// Those landings are counted in the skew along with the LS1 multicasts, so a pure speed change
+// reports the spread of its first phase.
+#define MOTOR_FRAME_SWITCH_REGISTER 0x07
+
+struct MotorSyncResult {
+    uint8_t drivers;        // drivers with a command in the frame
+    uint8_t stageBursts;    // first phase register bursts
+    uint8_t stageFailures;  // drivers with a failed first phase burst, left out of the second phase
+    uint8_t failedDrivers[SHADOW_CHANNEL_COUNT]; // those drivers by channel, bit n for address 0x60 + n
+    uint8_t switchWrites;   // second phase LS1 multicasts
+    uint8_t switchFailures; // multicasts that were not acknowledged, their drivers are left unknown in the shadow
+    uint8_t switchMismatches; // drivers of acknowledged multicasts whose LS1 read back wrong, left unknown too
+    uint8_t runningDutyWrites; // first phase duty writes that landed on outputs already running
+    uint32_t stageMicros;   // from the commit to the first phase landing
+    uint32_t skewMicros;    // first to last change of the outputs, LS1 multicasts and running duty writes, 0 with one or none
+    uint32_t landMicros;    // from the commit to the last write landing
+};
+
+MotorSyncResult motorFrameCommitSynchronous();
+
+// Skew of the synchronous commits since the last reset, in microseconds
+struct MotorSkewStats {
+    uint32_t frames;
+    uint32_t lastSkew;
+    uint32_t meanSkew;
+    uint32_t maxSkew;
+};
+
+MotorSkewStats getMotorSkewStats();
+void resetMotorSkewStats();
+
+// Drops the commands of the open frame, their registers are written in full by the next command
+void motorFrameAbort();
+
+#endif
@@ -26,6 +26,12 @@
 #include "Wire.h"
 #include "I2C_FCT.h" // Include the I2C functions header file
 #include "I2C_MUX.h" // Include the I2C multiplexer functions header file
+#include "I2C_Queue.h" // Include the background I2C transaction queue header file
+
+// One driver per multiplexer channel, each with two outputs.
+// PWM0 (register 0x03) drives output 0 and PWM1 (register 0x05) drives output 1.
+#define MOTOR_DRIVER_CHANNEL_COUNT 8
+#define MOTOR_DRIVER_OUTPUT_COUNT 2
 
 void motorDriverInit(uint8_t mux_channel, uint8_t address);
 void motorDriverRegControl(uint8_t mux_channel, uint8_t address, bool enable);
@@ -34,9 +40,75 @@ void setMotionControl(uint8_t mux_channel, uint8_t address, uint8_t speedOne, ui
 void defaultMotionControl(uint8_t mux_channel, uint8_t address, uint8_t defaultSpeed, bool direction);
 void motorDriverStop(uint8_t mux_channel, uint8_t address);
 
+// The motion commands without the bus writes, the registers are staged in the shadow for drivers
+// it covers and written straight away for any other. motorDriverFlush() queues what was staged for
+// a driver and returns the number of bursts. commandStart is the micros() the latency is measured from.
+// registerMask limits the flush to some registers, as for shadowTakeRuns().
+void stageVariableMotion(uint8_t mux_channel, uint8_t address, uint8_t speed, bool direction);
+void stageMotionControl(uint8_t mux_channel, uint8_t address, uint8_t speedOne, uint8_t speedTwo);
+void stageDefaultMotion(uint8_t mux_channel, uint8_t address, uint8_t defaultSpeed, bool direction);
+void stageMotorStop(uint8_t mux_channel, uint8_t address);
+void stageOutputSpeed(uint8_t mux_channel, uint8_t address, uint8_t output, uint8_t speed); // PWM0 or PWM1 only
+uint8_t motorDriverFlush(uint8_t mux_channel, uint8_t address, uint32_t commandStart, uint8_t registerMask = 0xFF);
+
+// Drivers on the channel with a queued burst that failed since the last call, bit n for address 0x60 + n.
+// Clears them.
+uint8_t takeMotorBurstFailures(uint8_t mux_channel);
+
+// Multicast functions, every driver at the address on the channels in the mask receives the same write
+// motorDriverInitAll() waits for each write to land, so it has a bounded run time and can be used for recovery
+I2C_Status motorDriverInitAll(uint8_t channelMask, uint8_t address);
+I2C_Status motorDriverMulticastWrite(uint8_t channelMask, uint8_t address, uint8_t registerAddress, uint8_t value);
+
+// Emergency stop: turns every output of all eight drivers off with one write.
+// Returns the time from the stop request to the write completing, in microseconds.
+uint32_t motorDriverStopAll(uint8_t address);
+uint32_t getMotorStopLatency();
+
+// Stop latency of one motorDriverStop() per driver against multicast stops, from the stop request to
+// the last write landing, in microseconds. Filled in by benchmarkRegisteredStop().
+struct MotorStopBenchmark {
+    uint32_t sequentialLatency;
+    uint32_t multicastLatency;
+};
+
+
+// Both read 0 if the driver did not answer, pass status to tell that apart from a real 0
+uint8_t readLimitTriggers(uint8_t mux_channel, uint8_t address, I2C_Status* status = nullptr);
+float readCurrentEstimate(uint8_t mux_channel, uint8_t address, I2C_Status* status = nullptr);
+
+// Both input registers of a driver, 0x00 (limit switches) and 0x01 (current code), read in one
+// auto-increment burst
+struct MotorDriverStatus {
+    uint8_t limitTriggers; // bits 0-3 of register 0x00
+    uint8_t currentCode;   // bits 3-7 of register 0x01, 0-31
+    I2C_Status status;     // I2C_OK if the fields are valid
+};
+
+MotorDriverStatus readDriverStatus(uint8_t mux_channel, uint8_t address);
+// Reads the status of the driver on every channel in one pass. Returns how many were read.
+uint8_t readAllDriverStatus(uint8_t address, MotorDriverStatus statuses[MOTOR_DRIVER_CHANNEL_COUNT]);
+float driverCurrentFromCode(uint8_t currentCode); // amps
+
+// Bus jobs and time for a status poll of all eight drivers, separate reads against the burst sweep
+struct MotorStatusBenchmark {
+    uint32_t separateJobs;
+    uint32_t separateMicros;
+    uint32_t sweepJobs;
+    uint32_t sweepMicros;
+};
+MotorStatusBenchmark benchmarkDriverStatus(uint8_t address);
+
+
+// Actuation timing
+
+// Kept for every driver at 0x60-0x67 on every channel, other addresses read 0.
 
-uint8_t readLimitTriggers(uint8_t mux_channel, uint8_t address);
-float readCurrentEstimate(uint8_t mux_channel, uint8_t address);
+// micros() when the last PWM write of an output completed on the bus, 0 if it was never written.
+// PWM writes are queued, so this is updated from the I2C interrupt once the write has landed.
+uint32_t getMotorPWMWriteTime(uint8_t mux_channel, uint8_t address, uint8_t output);
+// Filtered time from a motion command being called to its last PWM write landing, in microseconds
+uint32_t getMotorCommandLatency(uint8_t mux_channel, uint8_t address);
 
 
 #endif // MOTORDRIVER_LP3943_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+// MotorDriver_Registry.h
+// ----------------------
+// Function declarations for the LP3943 driver registry.
+// Discovery probes every address from 0x60 to 0x67 on every multiplexer channel, up to 64 drivers,
+// and builds an actuator map with two actuators per driver (output 0 on PWM0, output 1 on PWM1),
+// ordered by channel, then address, then output.
+//
+// Work is grouped so the multiplexer cost does not grow with the number of drivers: discovery switches
+// once per channel, initialisation is one multicast per address across every channel holding it, and
+// actuator commands go through motor frames, which switch once per channel.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef MOTORDRIVER_REGISTRY_H
+#define MOTORDRIVER_REGISTRY_H
+
+#include <Arduino.h>
+#include "MotorDriver_LP3943.h" // Multicast initialisation
+#include "MotorDriver_Shadow.h" // Channel and address range
+
+#define REGISTRY_MAX_DRIVERS (SHADOW_CHANNEL_COUNT * SHADOW_ADDRESS_COUNT)
+#define REGISTRY_MAX_ACTUATORS (REGISTRY_MAX_DRIVERS * MOTOR_DRIVER_OUTPUT_COUNT)
+
+struct Actuator {
+    uint8_t mux_channel;
+    uint8_t address;
+    uint8_t output; // 0 for PWM0, 1 for PWM1
+};
+
+// Probes every channel and address, replacing the registry. Returns the number of drivers found.
+uint8_t discoverMotorDrivers();
+
+uint8_t getRegisteredDriverCount();
+uint8_t getActuatorCount();
+bool getActuator(uint8_t index, Actuator& actuator);
+
+// Bit n set when the driver at address 0x60 + n answered on the channel
+uint8_t getRegisteredAddresses(uint8_t mux_channel);
+
+// Initialises every registered driver on the channels in the mask, one multicast per address
+I2C_Status initRegisteredDrivers(uint8_t channelMask = I2C_MUX_ALL_CHANNELS);
+
+// Emergency stop of every registered driver, one LS1 multicast per address to the channels holding it.
+// With nothing registered every channel at 0x60 is stopped. Returns the time from the stop request to
+// the last write landing, in microseconds.
+uint32_t stopRegisteredDrivers();
+
+// One motorDriverStop() per registered driver against stopRegisteredDrivers()
+MotorStopBenchmark benchmarkRegisteredStop();
+
+// Adds a speed for an actuator to the open motor frame, opening one if needed.
+// Commit the frame to write it.
+bool setActuatorSpeed(uint8_t index, uint8_t speed);
+
+// Builds an actuator map from the addresses present on each channel, without touching the bus.
+// Returns the number of actuators.
+uint8_t buildActuatorMap(const uint8_t addresses[SHADOW_CHANNEL_COUNT], Actuator* actuators);
+
+// Simulated full topology of 64 drivers. The registry is filled with every channel and address and the
+// real init, motion and frame commit code is run against the Wire bus in dry run, so nothing reaches
+// the pins. The jobs and multiplexer writes counted are those the code queued. One driver at a time
+// in address-major order, as the hand-written calls scale up, is compared against the registry's
+// grouped schedule. Bus time is worked out from the bits the jobs would have put on the wire.
+// Afterwards the real registry is restored and the shadow and multiplexer state are invalidated.
+// The actuation timing is not touched, writes made in dry run are not recorded.
+struct RegistryBenchmark {
+    uint8_t drivers;
+    uint8_t actuators;
+    uint32_t mapMicros;              // building the actuator map
+    uint32_t perDriverInitTransactions;
+    uint32_t groupedInitTransactions;
+    uint32_t perDriverFrameSwitches;  // multiplexer writes for a frame setting every actuator
+    uint32_t perDriverFrameTransactions;
+    uint32_t groupedFrameSwitches;
+    uint32_t groupedFrameTransactions;
+    uint32_t perDriverFrameMicros;    // bus time at the clock given
+    uint32_t groupedFrameMicros;
+};
+
+RegistryBenchmark benchmarkRegistryScaling(uint32_t clockHz);
+
+#endif
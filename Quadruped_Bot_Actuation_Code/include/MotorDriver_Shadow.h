@@ -0,0 +1,93 @@
+// MotorDriver_Shadow.h
+// --------------------
+// Function declarations for the shadow copy of the LP3943 configuration registers.
+// The shadow holds what was last written to registers 0x02-0x09 (PSC0, PWM0, PSC1, PWM1, LS0-LS3) of
+// every driver, by multiplexer channel and address 0x60-0x67. Motion commands stage register values
+// here, values the driver already holds are dropped, and the remaining dirty registers are taken as
+// runs that are written with one auto-increment burst each.
+//
+// A register is unknown until it has been written, and after the drivers are reset or re-initialised
+// their entries have to be invalidated so the next write goes out. Registers are counted as written
+// when their burst is queued, so a burst that fails on the bus has to be reported with
+// shadowWriteFailed(), otherwise every later write of the same value would be dropped.
+//
+// The last value written to each register is also kept as the commanded state, which invalidation
+// does not touch, so a driver re-initialised after a bus recovery can be put back as it was.
+// Writes made while the Wire bus is in dry run are not commanded.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef MOTORDRIVER_SHADOW_H
+#define MOTORDRIVER_SHADOW_H
+
+#include <Arduino.h>
+
+#define SHADOW_FIRST_REGISTER 0x02
+#define SHADOW_REGISTER_COUNT 8   // 0x02 to 0x09
+#define SHADOW_CHANNEL_COUNT 8    // multiplexer channels
+#define SHADOW_ADDRESS_BASE 0x60
+#define SHADOW_ADDRESS_COUNT 8    // LP3943 addresses 0x60 to 0x67
+#define SHADOW_MAX_RUNS (SHADOW_REGISTER_COUNT / 2) // dirty registers alternating with unknown ones
+#define SHADOW_REGISTER_BIT(registerAddress) (1 << ((registerAddress) - SHADOW_FIRST_REGISTER))
+#define SHADOW_BRIDGE_LIMIT 2     // clean registers written through to join two runs, cheaper than a new transaction
+
+// Registers written in one burst, starting at firstRegister
+struct ShadowRun {
+    uint8_t firstRegister;
+    uint8_t length;
+    uint8_t data[SHADOW_REGISTER_COUNT];
+};
+
+// Write elision counters since the last reset
+struct ShadowStats {
+    uint32_t hits;          // staged writes dropped, the driver already held the value
+    uint32_t misses;        // staged writes that had to go out
+    uint32_t transactions;  // bursts written
+    uint32_t bridged;       // clean registers rewritten to join runs
+};
+
+// True if the shadow holds the register of the driver at this channel and address
+bool shadowCovers(uint8_t mux_channel, uint8_t address, uint8_t registerAddress);
+
+// Stages a register value, marking it dirty unless the driver already holds it.
+// Returns false if the write was dropped. With force the write always goes out, as stops must.
+bool shadowStage(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t value, bool force = false);
+
+// Takes the dirty registers of a driver as burst runs and marks them written. Returns the number of runs.
+// Only registers in registerMask (bit n for register SHADOW_FIRST_REGISTER + n) are taken, the rest stay dirty.
+uint8_t shadowTakeRuns(uint8_t mux_channel, uint8_t address, ShadowRun runs[SHADOW_MAX_RUNS],
+                       uint8_t registerMask = 0xFF);
+
+// Takes a single dirty register and marks it written. Returns false if it was not dirty.
+bool shadowTakeRegister(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t& value);
+
+// Value the driver is known to hold. False if the register is unknown, or staged and not yet written.
+bool shadowGet(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t& value);
+
+// Records a value written outside the shadow, such as by a multicast
+void shadowSet(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t value);
+
+// Forgets registers of a driver whose write failed, so the next write to them goes out.
+// Safe to call from the I2C interrupt, the registers are forgotten at the next stage or take.
+void shadowWriteFailed(uint8_t mux_channel, uint8_t address, uint8_t registerMask);
+
+// Drops the staged registers of a driver without writing them. They become unknown, so the next
+// write to them goes out whatever its value.
+void shadowDiscard(uint8_t mux_channel, uint8_t address);
+
+// Registers last written to a driver and their values, bit n of the mask for register
+// SHADOW_FIRST_REGISTER + n and values indexed the same way. Returns 0 if it was never written.
+uint8_t shadowGetCommanded(uint8_t mux_channel, uint8_t address, uint8_t values[SHADOW_REGISTER_COUNT]);
+
+// Forgets what the drivers at the address on the channels in the mask hold, the commanded state is kept
+void shadowInvalidate(uint8_t channelMask, uint8_t address);
+void shadowInvalidateAll();
+
+ShadowStats getShadowStats();
+void resetShadowStats();
+
+#endif
@@ -0,0 +1,43 @@
+// NCDR_Acquisition.h
+// ------------------
+// Function declarations for background acquisition of the NCDR encoders.
+// A timer starts a sweep over all 16 channels using the ACTIVATE_MUX_FAST/readAllEncoders sequence,
+// with each byte moved by an asynchronous (DMA) SPI transfer. Completed sweeps are published into
+// double-buffered snapshots that the control loop can fetch without blocking.
+//
+// While acquisition is running the blocking encoder functions in SPI_NCDR_FCT.h must not be used,
+// as they would share the SPI bus and multiplexer with the background sweep.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_ACQUISITION_H
+#define NCDR_ACQUISITION_H
+
+#include <Arduino.h>
+#include "SPI_NCDR_FCT.h" // EncoderSnapshot and offsets
+
+#define NCDR_ACQUISITION_PERIOD_DEFAULT 1000 // microseconds between sweeps (1kHz)
+
+// Starts or stops the background sweep. The period must be longer than one sweep.
+void startEncoderAcquisition(uint32_t periodMicros = NCDR_ACQUISITION_PERIOD_DEFAULT);
+void stopEncoderAcquisition();
+bool isEncoderAcquisitionRunning();
+
+// Copies the latest published snapshot. Never blocks, returns false if no sweep has completed yet
+// or the snapshot was republished twice during the copy.
+bool getLatestEncoderSnapshot(EncoderSnapshot& snapshot);
+
+// Sequence number of the latest published snapshot, cheap to poll for new data
+uint32_t getEncoderSnapshotSequence();
+
+// Microseconds since the latest published snapshot completed
+uint32_t getEncoderSnapshotAge();
+
+// Number of timer ticks skipped because the previous sweep was still running
+uint32_t getEncoderAcquisitionOverruns();
+
+#endif
@@ -0,0 +1,62 @@
+// NCDR_Angle.h
+// ------------
+// Fixed-point angle type used by the encoder, control and telemetry paths.
+// An EncoderAngle is an unsigned Q16 fraction of a turn (65536 = one full turn), so wrap-around is exact
+// modulo 2^16 arithmetic and the differences between two angles are simply a signed 16-bit subtraction.
+// Conversion to degrees or radians is only done at the edges (serial output, user commands).
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_ANGLE_H
+#define NCDR_ANGLE_H
+
+#include <stdint.h>
+
+typedef uint16_t EncoderAngle;      // Q16 fraction of a turn, 0 to 65535
+typedef int16_t EncoderAngleDelta;  // signed Q16 difference, -half to +half a turn
+
+#define ENCODER_ANGLE_BITS 16
+#define NCDR_POSITION_BITS 12 // resolution of the encoders fitted
+
+// Scales a single-turn encoder count up to a Q16 angle, exact for any resolution up to 16 bits
+inline EncoderAngle encoderCountsToAngle(uint16_t counts) {
+    return (EncoderAngle)(counts << (ENCODER_ANGLE_BITS - NCDR_POSITION_BITS));
+}
+
+// Shortest signed difference from b to a, exact across the wrap
+inline EncoderAngleDelta angleDifference(EncoderAngle a, EncoderAngle b) {
+    return (EncoderAngleDelta)(uint16_t)(a - b);
+}
+
+// Edge conversions, keep these out of ISR and sweep code
+inline float angleToDegrees(EncoderAngle angle) {
+    return angle * (360.0f / 65536.0f);
+}
+
+inline float angleToRadians(EncoderAngle angle) {
+    return angle * (6.28318531f / 65536.0f);
+}
+
+inline float angleDeltaToDegrees(EncoderAngleDelta delta) {
+    return delta * (360.0f / 65536.0f);
+}
+
+inline EncoderAngle degreesToAngle(float degrees) {
+    // Rounded to the nearest step and wrapped into one turn
+    return (EncoderAngle)(int32_t)((degrees * (65536.0f / 360.0f)) + (degrees >= 0 ? 0.5f : -0.5f));
+}
+
+// Cycles per sample of the old float degrees path and the fixed-point path, measured on target
+struct AnglePathBenchmark {
+    uint32_t samples;
+    float floatCyclesPerSample;
+    float fixedCyclesPerSample;
+};
+
+AnglePathBenchmark benchmarkAnglePaths(uint32_t samples);
+
+#endif
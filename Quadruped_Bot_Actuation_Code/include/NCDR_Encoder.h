@@ -0,0 +1,78 @@
+// NCDR_Encoder.h
+// --------------
+// Compile-time description of the NCDR encoder models fitted to the robot.
+// NCDR_Encoder is parameterised on the position resolution and the command protocol, so each model
+// decodes its responses with a constant shift and mask and verifies the two check bits inline.
+// Mixed models can share the SPI multiplexer: the model of each channel is chosen at compile time
+// through NCDR_ChannelEncoder and only changes constants, never the code path.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_ENCODER_H
+#define NCDR_ENCODER_H
+
+#include <stdint.h>
+#include "NCDR_Angle.h" // Fixed-point angle type
+
+// Command bytes of the AMT22 family, each sent as the second byte of a transfer
+struct NCDR_AMT22Protocol {
+    static constexpr uint8_t POSITION_COMMAND = 0x00;
+    static constexpr uint8_t TURNS_COMMAND = 0xA0;  // multi-turn models only
+    static constexpr uint8_t RESET_COMMAND = 0x60;  // reboots the encoder
+    static constexpr uint8_t TURNS_BITS = 14;       // width of the signed turns counter
+    static constexpr uint16_t RESET_TIME_MS = 200;  // time for the encoder to reboot
+};
+
+template <uint8_t ResolutionBits, class ProtocolType>
+struct NCDR_Encoder {
+    static_assert(ResolutionBits >= 10 && ResolutionBits <= 14, "Position must fit the 14 data bits of a response");
+
+    typedef ProtocolType Protocol;
+    static constexpr uint8_t RESOLUTION_BITS = ResolutionBits;
+    static constexpr uint32_t COUNTS_PER_TURN = 1UL << ResolutionBits;
+
+    // Every response is two check bits followed by 14 data bits, the position is left aligned in the data bits
+    static constexpr uint16_t DATA_MASK = 0x3FFF;
+    static constexpr uint8_t POSITION_SHIFT = 14 - ResolutionBits;
+
+    // Bits of a Q16 angle this model resolves, the unused low bits of lower resolution models are cleared
+    static constexpr EncoderAngle ANGLE_MASK = (EncoderAngle)(0xFFFF << (ENCODER_ANGLE_BITS - ResolutionBits));
+
+    // K1 (bit 15) gives odd parity over the odd bits and K0 (bit 14) gives odd parity over the even bits
+    static inline bool checkBitsValid(uint16_t word) {
+        return __builtin_parity(word & 0xAAAA) && __builtin_parity(word & 0x5555);
+    }
+
+    static inline uint16_t decodeCounts(uint16_t word) {
+        return (word & DATA_MASK) >> POSITION_SHIFT;
+    }
+
+    static inline EncoderAngle decodeAngle(uint16_t word) {
+        return (EncoderAngle)((word & DATA_MASK) << 2) & ANGLE_MASK;
+    }
+
+    // Sign-extends the turns counter from the top of the data bits
+    static inline int16_t decodeTurns(uint16_t word) {
+        return (int16_t)((word & DATA_MASK) << (16 - Protocol::TURNS_BITS)) >> (16 - Protocol::TURNS_BITS);
+    }
+};
+
+typedef NCDR_Encoder<12, NCDR_AMT22Protocol> NCDR_AMT22_12Bit;
+typedef NCDR_Encoder<14, NCDR_AMT22Protocol> NCDR_AMT22_14Bit;
+
+// Model used wherever a channel is not given its own
+typedef NCDR_Encoder<NCDR_POSITION_BITS, NCDR_AMT22Protocol> NCDR_DefaultEncoder;
+
+// Model fitted to each channel. Specialise here for channels fitted with a different model, e.g.
+//   template <> struct NCDR_ChannelEncoder<4> { typedef NCDR_AMT22_14Bit type; };
+// All models sharing the bus must use the same protocol.
+template <uint8_t Channel>
+struct NCDR_ChannelEncoder {
+    typedef NCDR_DefaultEncoder type;
+};
+
+#endif
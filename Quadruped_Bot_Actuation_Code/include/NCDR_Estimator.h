@@ -0,0 +1,68 @@
+// NCDR_Estimator.h
+// ----------------
+// Function declarations for estimating the position, velocity and acceleration of each joint.
+// Each channel runs an alpha-beta-gamma filter fed by the timestamped samples of the encoder sweeps.
+// The filter uses the measured time between samples, so sweep jitter and skipped samples are handled,
+// and the residual is taken as a Q16 angle difference so the single-turn wrap never shows as a jump.
+// Every update is a fixed number of operations, independent of history.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_ESTIMATOR_H
+#define NCDR_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "SPI_NCDR_FCT.h" // EncoderSample and EncoderSnapshot
+
+// Default filter gains, stable for 0 < alpha < 2, 0 < beta < 4 - 2 * alpha and 0 < gamma < 4 * alpha * beta / (2 - alpha)
+#define JOINT_ESTIMATOR_ALPHA_DEFAULT 0.5f
+#define JOINT_ESTIMATOR_BETA_DEFAULT 0.15f
+#define JOINT_ESTIMATOR_GAMMA_DEFAULT 0.01f
+
+// A gap between two samples longer than this restarts the filter from the measured position
+#define JOINT_ESTIMATOR_MAX_GAP_US 20000
+
+// Estimated state of a joint, in turns of the encoder shaft
+struct JointState {
+    float position;     // unwrapped position in turns
+    float velocity;     // turns per second
+    float acceleration; // turns per second squared
+    uint32_t timestamp; // micros() of the last sample used
+    bool valid;         // false until the filter has seen a sample
+};
+
+// Feeds one offset-corrected sample into the filter of a channel. Invalid samples are ignored,
+// the next valid one is filtered over the longer time step.
+void updateJointEstimator(uint8_t channel, const EncoderSample& sample);
+
+// Feeds every channel of a snapshot
+void updateJointEstimators(const EncoderSnapshot& snapshot);
+
+// Feeds the latest sweep published by the background acquisition, if it has not been fed already.
+// Call every pass of the main loop so the filters see the samples at the sweep rate, a pass slower
+// than JOINT_ESTIMATOR_MAX_GAP_US restarts them. Does nothing while acquisition is stopped.
+void serviceJointEstimators();
+
+// Latest estimate of a channel
+JointState getJointState(uint8_t channel);
+
+// Restarts the filter of a channel from its next sample
+void resetJointEstimator(uint8_t channel);
+
+// Filter gains of a channel, the filter is restarted when they change
+void setJointEstimatorGains(uint8_t channel, float alpha, float beta, float gamma);
+
+// Runs a fresh filter with the default gains over a recorded stream of samples of one channel,
+// writing the estimate after each sample into states. The live filters are not touched.
+void replayJointEstimator(const EncoderSample* samples, uint16_t count, JointState* states);
+
+// Replays synthetic recorded streams (constant speed across the wrap, constant acceleration and
+// a joint at rest with count noise, all with jittered timestamps) and reports the estimation errors.
+// Returns true if every stream settled within tolerance.
+bool selfTestJointEstimator();
+
+#endif
@@ -0,0 +1,45 @@
+// NCDR_JointTracker.h
+// -------------------
+// Function declarations for tracking the absolute multi-turn position of each joint.
+// Single-turn positions from the encoder sweeps are unwrapped in software into a signed 32-bit count,
+// and the turns counter of the encoder is only read periodically to resync the count.
+//
+// The unwrap assumes a joint moves less than half a turn between two updates.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_JOINTTRACKER_H
+#define NCDR_JOINTTRACKER_H
+
+#include <Arduino.h>
+#include "SPI_NCDR_FCT.h" // EncoderSnapshot and readPositionAndTurns()
+
+#define NCDR_COUNTS_PER_TURN (1L << NCDR_POSITION_BITS)
+#define JOINT_TURN_SYNC_INTERVAL_DEFAULT 100 // snapshots between turn resyncs
+
+// Feeds one offset-corrected single-turn angle into the tracker of a channel
+void updateJointTracker(uint8_t channel, EncoderAngle angle);
+
+// Feeds every channel of a snapshot. Each time the sync interval elapses the turns of one channel
+// are resynced, round robin, so readTurns() costs are spread out. No resync is done while
+// background acquisition owns the SPI bus.
+void updateJointTrackers(const EncoderSnapshot& snapshot);
+
+// Reads the turns counter of a channel and sets its absolute count from it
+void syncJointTurns(uint8_t channel);
+
+// Number of snapshots between turn resyncs, 0 disables resyncing
+void setJointTurnSyncInterval(uint16_t snapshots);
+
+// Absolute position of a joint in encoder counts
+int32_t getJointCounts(uint8_t channel);
+
+// Absolute position of a joint in scaled units, degrees of the encoder shaft by default
+float getJointPosition(uint8_t channel);
+void setJointScale(uint8_t channel, float unitsPerCount);
+
+#endif
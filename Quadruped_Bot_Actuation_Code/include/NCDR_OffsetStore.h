@@ -0,0 +1,41 @@
+// NCDR_OffsetStore.h
+// ------------------
+// Function declarations for keeping the encoder zero offsets in EEPROM.
+// The offsets are stored as one versioned record protected by a CRC, so they can be loaded at boot
+// instead of rebooting and re-zeroing every encoder.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_OFFSETSTORE_H
+#define NCDR_OFFSETSTORE_H
+
+#include <Arduino.h>
+#include "SPI_NCDR_FCT.h" // Encoder offsets
+
+#define NCDR_OFFSET_RECORD_MAGIC 0x5244434EUL // "NCDR"
+#define NCDR_OFFSET_RECORD_VERSION 1          // bump when the record layout changes
+
+// Record as stored in EEPROM
+struct EncoderOffsetRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t channelCount;
+    EncoderAngle offsets[NCDR_CHANNEL_COUNT];
+    uint16_t crc; // CRC-16/CCITT over all the fields above
+};
+
+// Loads the stored offsets into the encoder driver. Returns false, leaving the offsets untouched,
+// if there is no record or its magic, version, channel count or CRC do not match.
+bool loadEncoderOffsets();
+
+// Writes the current offsets of the encoder driver to EEPROM
+void saveEncoderOffsets();
+
+// Explicit calibration: reboots all encoders in parallel, takes new offsets and saves them
+bool calibrateEncoders();
+
+#endif
@@ -0,0 +1,55 @@
+// NCDR_Prediction.h
+// -----------------
+// Function declarations for compensating the encoder-to-motor latency of each joint.
+// A joint keeps moving between its encoder sample and the moment its LP3943 PWM write lands on the bus,
+// so controllers should use the joint state extrapolated to that moment instead of the raw sample.
+// The expected landing time comes from the measured command latency of the motor driver, and the
+// actual sense-to-actuate latency of every command is recorded so the compensation can be validated.
+// Predictions start from the estimator state, so the estimators must be fed continuously by
+// serviceJointEstimators() for the velocity and acceleration to mean anything.
+//
+// Joint j is driven by output j % 2 of the motor driver on I2C mux channel j / 2, matching the
+// leg pairing of the encoder sweep order.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef NCDR_PREDICTION_H
+#define NCDR_PREDICTION_H
+
+#include <Arduino.h>
+#include "NCDR_Estimator.h"     // JointState
+#include "MotorDriver_LP3943.h" // PWM write times
+
+#define JOINT_MOTOR_CHANNEL(joint) ((joint) / NCDR_JOINTS_PER_LEG)
+#define JOINT_MOTOR_OUTPUT(joint) ((joint) % NCDR_JOINTS_PER_LEG)
+#define JOINT_MOTOR_ADDRESS(joint) 0x60 // every leg driver sits at the default address
+
+// Joint state extrapolated from its last estimate to a given micros() time
+JointState predictJointState(uint8_t joint, uint32_t atTime);
+
+// Joint state extrapolated to when a motor command issued now is expected to land.
+// The prediction is remembered until recordJointActuation() is called for the joint.
+JointState predictJointAtActuation(uint8_t joint);
+
+// Call once the motor command based on predictJointAtActuation() has landed, motor writes are queued
+// so wait for the I2C queue to go idle first.
+// Records the sense-to-actuate latency and how far the expected landing time was off.
+void recordJointActuation(uint8_t joint);
+
+// Sense-to-actuate latency of a joint: encoder sample to PWM write landing, in microseconds
+struct JointLatencyStats {
+    uint32_t commands;          // number of recorded actuations
+    uint32_t minLatency;
+    uint32_t meanLatency;
+    uint32_t maxLatency;
+    int32_t meanLandingError;   // actual minus expected landing time
+};
+
+JointLatencyStats getJointLatencyStats(uint8_t joint);
+void resetJointLatencyStats();
+
+#endif
@@ -34,4 +34,9 @@
 
 #define PACK_SNS 23 //pack sense input, input
 
+#define I2C_SDA_PIN 18 //Wire data, multiplexer and motor drivers. Only driven directly during bus recovery
+#define I2C_SCL_PIN 19 //Wire clock
+#define I2C1_SDA_PIN 17 //Wire1 data, BMS
+#define I2C1_SCL_PIN 16 //Wire1 clock
+
 #endif
\ No newline at end of file
@@ -19,4 +19,15 @@ void SPI_CS_MUX(uint8_t newChannel);
 void ACTIVATE_MUX(uint8_t SPI_channel);
 void DEACTIVATE_MUX();
 
+// Fast path used by the encoder sweep. Writes the mux pins directly and settles in nanoseconds
+// instead of the millisecond strobe delays used by ACTIVATE_MUX().
+void ACTIVATE_MUX_FAST(uint8_t SPI_channel);
+void DEACTIVATE_MUX_FAST();
+
+// Split form of ACTIVATE_MUX_FAST used for pipelined reads. While STROBE is low the outputs hold the
+// latched channel, so the next channel can be preloaded onto CS_1..CS_4 during a transfer and
+// latched once the current channel has been released.
+void SPI_MUX_PRELOAD(uint8_t SPI_channel);
+void SPI_MUX_LATCH();
+
 #endif
\ No newline at end of file
@@ -15,10 +15,82 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "SPI_NCDR_TIMING.h" // Channel count and datasheet timings
+#include "NCDR_Angle.h" // Fixed-point angle type
+#include "NCDR_Encoder.h" // Encoder models and protocol
+
+#define NCDR_JOINTS_PER_LEG 2
+#define NCDR_LEG_COUNT (NCDR_CHANNEL_COUNT / NCDR_JOINTS_PER_LEG)
+
+// One position sample taken during a sweep
+struct EncoderSample {
+    EncoderAngle angle; // position with the channel offset applied, Q16 fraction of a turn
+    uint32_t timestamp; // micros() when the position word was clocked out
+    bool valid;         // false if the check bits of the response did not match
+};
+
+// Result of a sweep over all encoder channels
+struct EncoderSnapshot {
+    EncoderSample samples[NCDR_CHANNEL_COUNT];
+    uint32_t sweepStart;    // micros() at the start of the sweep
+    uint32_t sweepDuration; // time taken by the whole sweep in microseconds
+    uint32_t sequence;      // increments once per completed sweep, 0 means no data yet
+};
 
 // Function declarations
-float readEncoderPosition(uint8_t channel);
+float readEncoderPosition(uint8_t channel); // returns NAN if the check bits do not match
 int16_t readTurns(uint8_t channel);
 void resetEncoder(uint8_t channel);
 
+// Reads the raw angle (no offset applied) and the turns counter in one transfer,
+// returns false if the check bits of either response do not match
+bool readPositionAndTurns(uint8_t channel, EncoderAngle& angle, int16_t& turns);
+
+// Reads all 16 channels in one pass using the fast mux path
+EncoderSnapshot readAllEncoders();
+
+// Same sweep with the mux select of the next channel overlapped with the current transfer,
+// and the decode of each channel overlapped with the CS setup time of the next
+EncoderSnapshot readAllEncodersPipelined();
+
+// Order channels are sampled in by the sweeps. Entries 2n and 2n+1 are the two joints of leg n,
+// so both joints of a leg are always sampled back to back. Defaults to 0,1,2...15.
+bool setEncoderSweepOrder(const uint8_t order[NCDR_CHANNEL_COUNT]);
+const uint8_t* getEncoderSweepOrder();
+
+// Time between the samples of the two joints of a leg in a snapshot, in microseconds
+uint32_t getEncoderPairSkew(const EncoderSnapshot& snapshot, uint8_t leg);
+
+// Results of benchmarkEncoderSweep(), all times in microseconds
+struct EncoderSweepBenchmark {
+    uint16_t iterations;
+    uint32_t meanSweep;       // pipelined sweep
+    uint32_t maxSweep;        // pipelined sweep
+    uint32_t meanSerialSweep; // readAllEncoders() for comparison
+    uint32_t worstPairSkew;   // largest skew between the two joints of a leg
+    uint8_t worstPairLeg;     // leg the worst skew was seen on
+};
+
+// Runs both sweeps a number of times and reports sweep time and worst intra-leg skew
+EncoderSweepBenchmark benchmarkEncoderSweep(uint16_t iterations);
+
+// Subtracts the zero offset of a channel from a raw angle
+EncoderAngle applyEncoderOffset(uint8_t channel, EncoderAngle angle);
+EncoderAngle getEncoderOffset(uint8_t channel);
+void setEncoderOffset(uint8_t channel, EncoderAngle offset);
+
+// Reboots every encoder at once, waits a single reboot time and takes the new zero offsets from one sweep.
+// Returns false if any channel failed its check bits, that channel is left with a zero offset.
+bool zeroAllEncoders();
+
+// Decodes a position response of a channel into a sample, verifying the check bits
+bool decodeEncoderSample(uint8_t channel, uint16_t word, EncoderSample& sample);
+
+// Number of responses from a channel that failed the check bits
+uint32_t getEncoderCheckErrors(uint8_t channel);
+
+// SPI clock used for all encoder transfers, defaults to NCDR_SPI_CLOCK_DEFAULT
+void setEncoderSPIClock(uint32_t clockHz);
+uint32_t getEncoderSPIClock();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+// SPI_NCDR_TIMING.h
+// -----------------
+// Timing constants and a timing model for the SPI multiplexer and the NCDR encoders.
+// The constants are shared with the sweep code in SPI_MUX.cpp and SPI_NCDR_FCT.cpp so the
+// model and the firmware can never drift apart.
+// This header has no Arduino dependencies, so the sweep budget can also be checked off-target
+// by compiling it on the host (e.g. g++ -fsyntax-only -x c++ SPI_NCDR_TIMING.h).
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+#ifndef SPI_NCDR_TIMING_H
+#define SPI_NCDR_TIMING_H
+
+#include <stdint.h>
+
+#define NCDR_CHANNEL_COUNT 16 // number of encoder channels behind the SPI multiplexer
+
+// SPI multiplexer (4 to 16 line decoder with latch) timings, in nanoseconds
+#define SPI_MUX_STROBE_NS 500   // width of the STROBE pulse that latches CS_1..CS_4
+#define SPI_MUX_SETTLE_NS 1000  // decoder output settling after INHIBIT goes low
+#define SPI_MUX_RELEASE_NS 500  // decoder output release after INHIBIT goes high
+
+// Encoder timings as prescribed by the datasheet, in microseconds
+#define NCDR_CS_SETUP_US 3   // chip select to first clock edge
+#define NCDR_BYTE_GAP_US 3   // gap between the two bytes of a position read
+#define NCDR_CS_HOLD_US 3    // chip select held after the last byte
+
+#define NCDR_SPI_CLOCK_DEFAULT 1000000 // 1MHz, the encoders accept up to 2MHz
+#define NCDR_SPI_OVERHEAD_NS 500       // per byte software overhead of SPI.transfer()
+
+#define NCDR_SWEEP_BUDGET_US 1000 // target for one pass over all 16 channels
+
+// Time to clock a number of bytes out at the given SPI clock
+constexpr uint32_t ncdrTransferNs(uint32_t clockHz, uint8_t bytes) {
+    return (uint32_t)(((uint64_t)bytes * (8000000000ULL / clockHz + NCDR_SPI_OVERHEAD_NS)));
+}
+
+// Time to read the position of one channel using the fast mux path
+constexpr uint32_t ncdrChannelReadNs(uint32_t clockHz) {
+    return SPI_MUX_STROBE_NS + SPI_MUX_SETTLE_NS
+         + NCDR_CS_SETUP_US * 1000UL
+         + ncdrTransferNs(clockHz, 2)
+         + NCDR_BYTE_GAP_US * 1000UL
+         + NCDR_CS_HOLD_US * 1000UL
+         + SPI_MUX_RELEASE_NS;
+}
+
+// Time to sweep a number of channels using the fast mux path
+constexpr uint32_t ncdrSweepNs(uint32_t clockHz, uint8_t channels) {
+    return ncdrChannelReadNs(clockHz) * channels;
+}
+
+// Time to read one channel through readEncoderPosition(), dominated by the two 10ms strobes in ACTIVATE_MUX()
+constexpr uint32_t ncdrLegacyChannelReadNs(uint32_t clockHz) {
+    return 20000000UL + 3000UL * 6 + ncdrTransferNs(clockHz, 2);
+}
+
+static_assert(ncdrSweepNs(NCDR_SPI_CLOCK_DEFAULT, NCDR_CHANNEL_COUNT) < NCDR_SWEEP_BUDGET_US * 1000UL,
+              "Encoder sweep at the default SPI clock does not fit the sweep budget");
+
+#endif
@@ -18,8 +18,12 @@
 #include "BMS_CoreCommands.h"
 #include "BMS_SetupCommands.h"
 #include "BMS_NumericalCommands.h"
+#include "BMS_Config.h"
 
 
 void SetUpBMS();
 
+// Encodes the startup configuration, returns false if a setting is invalid
+bool getBMSConfigImage(BmsConfigImage& image);
+
 #endif
\ No newline at end of file
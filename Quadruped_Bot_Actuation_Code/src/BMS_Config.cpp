@@ -0,0 +1,155 @@
+// BMS_Config.cpp
+// --------------
+// Implementation of the transactional BMS configuration.
+// The image is kept in register order so the reads cover it in a few block reads, and the writes
+// are queued back to back on Wire1 with one wait at the end.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "BMS_Config.h"
+#include "BMS_ReadCommands.h" // Measurement block start
+
+static const uint8_t bmsAddress = 0x49;
+
+// Failures of the queued writes, set from the I2C interrupt
+static volatile uint8_t writeFailures = 0;
+static volatile I2C_Status writeStatus = I2C_OK;
+
+static void onConfigWritten(const I2C_Job& job) {
+    if (job.state != I2C_JOB_DONE) {
+        writeFailures++;
+        if (writeStatus == I2C_OK) {
+            writeStatus = job.status;
+        }
+    }
+}
+
+// Reads every register of the image, one block read per run of consecutive addresses
+static I2C_Status readImageRegisters(const BmsConfigImage& image, uint16_t* words) {
+    I2C_Status result = I2C_OK;
+    uint8_t start = 0;
+    while (start < image.count) {
+        uint8_t end = start + 1;
+        while (end < image.count && image.address[end] == image.address[end - 1] + 1) {
+            end++;
+        }
+        I2C_Status status = readBMSBlock(bmsAddress, image.address[start], &words[start], end - start);
+        if (status != I2C_OK && result == I2C_OK) {
+            result = status;
+        }
+        start = end;
+    }
+    return result;
+}
+
+static bool registerDiffers(const BmsConfigImage& image, uint8_t index, uint16_t word) {
+    uint16_t mask = image.compareMask[index];
+    return mask == 0 || (word & mask) != (image.value[index] & mask);
+}
+
+
+bool buildBMSConfigImage(const BmsConfigSetting* settings, uint8_t count, BmsConfigImage& image) {
+    image.count = 0;
+    for (uint8_t setting = 0; setting < count; setting++) {
+        const BmsRegisterDescriptor& reg = getBMSRegister(settings[setting].id);
+        uint16_t value = 0;
+        if (reg.group == BMS_GROUP_REALTIME || reg.group == BMS_GROUP_NVM ||
+            encodeBMSCommand(reg, settings[setting].arg1, settings[setting].arg2, value) == BMS_ENCODE_INVALID) {
+            Serial.print("Error: Invalid BMS configuration setting ");
+            Serial.println(reg.name);
+            return false;
+        }
+
+        // Insert in register order, a later setting of the same register replaces the earlier one
+        uint8_t index = 0;
+        while (index < image.count && image.address[index] < reg.address) {
+            index++;
+        }
+        if (index == image.count || image.address[index] != reg.address) {
+            if (image.count == BMS_CONFIG_MAX_REGISTERS) {
+                Serial.println("Error: BMS configuration image is full.");
+                return false;
+            }
+            for (uint8_t move = image.count; move > index; move--) {
+                image.address[move] = image.address[move - 1];
+                image.value[move] = image.value[move - 1];
+                image.compareMask[move] = image.compareMask[move - 1];
+            }
+            image.count++;
+        }
+        image.address[index] = reg.address;
+        image.value[index] = value;
+        image.compareMask[index] = (reg.address < BMS_MEASUREMENT_FIRST_REGISTER) ? getBMSWritableMask(reg) : 0;
+    }
+    return true;
+}
+
+uint8_t compareBMSConfigImage(const BmsConfigImage& image, uint16_t* words, I2C_Status& status) {
+    status = readImageRegisters(image, words);
+    uint8_t differing = 0;
+    for (uint8_t index = 0; index < image.count; index++) {
+        if (image.compareMask[index] != 0 && registerDiffers(image, index, words[index])) {
+            differing++;
+        }
+    }
+    return differing;
+}
+
+BmsConfigResult applyBMSConfigImage(const BmsConfigImage& image) {
+    BmsConfigResult result = {image.count, 0, 0, 0, I2C_OK, 0, false};
+    uint32_t start = micros();
+
+    // Read back what the device holds, nothing is written yet so conversions can keep running
+    uint16_t words[BMS_CONFIG_MAX_REGISTERS];
+    result.status = readImageRegisters(image, words);
+    bool differs[BMS_CONFIG_MAX_REGISTERS];
+    for (uint8_t index = 0; index < image.count; index++) {
+        differs[index] = registerDiffers(image, index, words[index]);
+        if (differs[index]) {
+            result.differing++;
+        }
+    }
+
+    if (result.differing > 0) {
+        // One conversion-off window for every write
+        setBMSConversionState("CONVERSION_OFF");
+
+        writeFailures = 0;
+        writeStatus = I2C_OK;
+        for (uint8_t index = 0; index < image.count; index++) {
+            if (!differs[index]) {
+                continue;
+            }
+            const uint8_t data[] = {image.address[index], (uint8_t)(image.value[index] >> 8), (uint8_t)image.value[index]};
+            I2C_EnqueueWaiting(I2C_BUS_WIRE1, bmsAddress, data, sizeof(data), 0, onConfigWritten);
+        }
+        I2C_WaitIdle(I2C_BUS_WIRE1);
+        result.writeFailures = writeFailures;
+        if (result.status == I2C_OK) {
+            result.status = writeStatus;
+        }
+
+        // Verify the registers that can be compared
+        I2C_Status verifyStatus = readImageRegisters(image, words);
+        if (result.status == I2C_OK) {
+            result.status = verifyStatus;
+        }
+        for (uint8_t index = 0; index < image.count; index++) {
+            if (image.compareMask[index] != 0 && registerDiffers(image, index, words[index])) {
+                result.verifyFailures++;
+            }
+        }
+    }
+
+    if (bmsConversionActive != 1) {
+        setBMSConversionState("CONVERSION_ON");
+    }
+    result.durationMicros = micros() - start;
+    result.verified = (result.status == I2C_OK && result.writeFailures == 0 && result.verifyFailures == 0);
+    return result;
+}
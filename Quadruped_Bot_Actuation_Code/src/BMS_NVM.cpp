@@ -0,0 +1,202 @@
+// BMS_NVM.cpp
+// -----------
+// Implementation of the BMS fast boot from NVM and the NVM commit budget.
+// The budget is a small CRC-protected record in EEPROM. A missing record starts the count at
+// BMS_NVM_PRIOR_COMMITS, a corrupt one refuses every commit rather than guess at the count.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include <EEPROM.h>
+#include "EEPROM_Map.h"
+#include "BMS_NVM.h"
+
+static_assert(sizeof(BmsNvmBudgetRecord) <= 16, "BMS NVM budget record outgrew its EEPROM reservation");
+
+static const uint8_t bmsAddress = 0x49;
+static const uint8_t identityFirstRegister = 0x17; // MANUFACTURE_NAME_MSB
+static const uint8_t identityRegisterCount = 8;    // up to DEVICE_NAME_LSB (0x1E)
+
+// CRC-16/CCITT (polynomial 0x1021), continuing from crc
+static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Version 1 of the record, before fingerprintValid
+struct BmsNvmBudgetRecordV1 {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t commits;
+    uint16_t fingerprint; // 0 if unknown
+    uint16_t crc;
+};
+
+static uint16_t recordCrc(const BmsNvmBudgetRecord& record) {
+    return crc16((const uint8_t*)&record, offsetof(BmsNvmBudgetRecord, crc));
+}
+
+// Loads the budget record. Returns false if it is corrupt, a missing record reads as a fresh one.
+static bool loadBudget(BmsNvmBudgetRecord& record) {
+    EEPROM.get(EEPROM_BMS_NVM_BUDGET_ADDRESS, record);
+    if (record.magic != BMS_NVM_BUDGET_MAGIC) {
+        memset(&record, 0, sizeof(record));
+        record.magic = BMS_NVM_BUDGET_MAGIC;
+        record.version = BMS_NVM_BUDGET_VERSION;
+        record.commits = BMS_NVM_PRIOR_COMMITS;
+        return true;
+    }
+    if (record.version == 1) {
+        // Keep the count. Its fingerprint of 0 meant unknown, which cannot be told from a real 0, so drop it.
+        BmsNvmBudgetRecordV1 old;
+        EEPROM.get(EEPROM_BMS_NVM_BUDGET_ADDRESS, old);
+        if (old.crc != crc16((const uint8_t*)&old, offsetof(BmsNvmBudgetRecordV1, crc))) {
+            return false;
+        }
+        memset(&record, 0, sizeof(record));
+        record.magic = BMS_NVM_BUDGET_MAGIC;
+        record.version = BMS_NVM_BUDGET_VERSION;
+        record.commits = old.commits;
+        record.fingerprint = old.fingerprint;
+        record.fingerprintValid = (old.fingerprint != 0);
+        return true;
+    }
+    return record.version == BMS_NVM_BUDGET_VERSION && record.crc == recordCrc(record);
+}
+
+
+uint16_t bmsConfigFingerprint(const BmsConfigImage& image, const uint16_t* words) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t index = 0; index < image.count; index++) {
+        uint16_t mask = image.compareMask[index];
+        if (mask == 0) {
+            continue; // not comparable, so not part of the fingerprint
+        }
+        uint16_t value = (words ? words[index] : image.value[index]) & mask;
+        const uint8_t bytes[] = {image.address[index], (uint8_t)(value >> 8), (uint8_t)value};
+        crc = crc16(bytes, sizeof(bytes), crc);
+    }
+    return crc;
+}
+
+BmsFastBootResult bmsFastBoot(const BmsConfigImage& image) {
+    BmsFastBootResult result = {};
+    uint32_t start = micros();
+
+    // Upload the NVM into the I2C registers. After an MCU-only reset the registers already hold
+    // the previous values, so nothing read back can show the upload has landed, wait it out instead.
+    writeBMSRegister(getBMSRegister(BMS_NVM_2_UL), (uint16_t)getBMSRegister(BMS_NVM_2_UL).fields[0].defaultValue);
+    delayMicroseconds(BMS_NVM_UPLOAD_US);
+    result.uploadMicros = micros() - start;
+
+    uint16_t identity[identityRegisterCount];
+    I2C_Status identityStatus = readBMSBlock(bmsAddress, identityFirstRegister, identity, identityRegisterCount);
+    result.identityValid = (identityStatus == I2C_OK);
+    for (uint8_t index = 0; index < identityRegisterCount; index++) {
+        if (identity[index] == 0x0000) {
+            result.identityValid = false;
+        }
+    }
+
+    uint16_t words[BMS_CONFIG_MAX_REGISTERS];
+    I2C_Status status;
+    result.differing = compareBMSConfigImage(image, words, status);
+    result.expectedFingerprint = bmsConfigFingerprint(image);
+    result.committedFingerprintValid = getBMSNvmFingerprint(result.committedFingerprint);
+
+    // Matching registers alone could be left over from a full write, only trust the NVM if it was committed with this image
+    result.loadedFromNvm = (status == I2C_OK && result.identityValid && result.differing == 0 &&
+                            result.committedFingerprintValid &&
+                            result.committedFingerprint == result.expectedFingerprint);
+    if (result.loadedFromNvm) {
+        if (bmsConversionActive != 1) {
+            setBMSConversionState("CONVERSION_ON");
+        }
+    } else {
+        result.fallback = applyBMSConfigImage(image);
+    }
+    result.durationMicros = micros() - start;
+    return result;
+}
+
+// Counts a commit, recording the fingerprint of what it commits if known
+static bool takeCommit(uint16_t fingerprint, bool fingerprintValid) {
+    BmsNvmBudgetRecord record;
+    if (!loadBudget(record)) {
+        Serial.println("Error: BMS NVM commit count is corrupt, refusing to commit.");
+        return false;
+    }
+    if (record.commits >= BMS_NVM_COMMIT_LIMIT) {
+        Serial.println("Error: BMS NVM commit budget is spent, refusing to commit.");
+        return false;
+    }
+
+    // Counted before the commit is issued, so a reset part way through still uses it up
+    record.commits++;
+    record.fingerprint = fingerprintValid ? fingerprint : 0;
+    record.fingerprintValid = fingerprintValid ? 1 : 0;
+    record.crc = recordCrc(record);
+    EEPROM.put(EEPROM_BMS_NVM_BUDGET_ADDRESS, record);
+    return true;
+}
+
+bool takeBMSNvmCommit() {
+    return takeCommit(0, false);
+}
+
+bool takeBMSNvmCommit(uint16_t fingerprint) {
+    return takeCommit(fingerprint, true);
+}
+
+uint8_t getBMSNvmCommitsRemaining() {
+    BmsNvmBudgetRecord record;
+    if (!loadBudget(record) || record.commits >= BMS_NVM_COMMIT_LIMIT) {
+        return 0;
+    }
+    return BMS_NVM_COMMIT_LIMIT - record.commits;
+}
+
+bool getBMSNvmFingerprint(uint16_t& fingerprint) {
+    BmsNvmBudgetRecord record;
+    if (!loadBudget(record) || !record.fingerprintValid) {
+        return false;
+    }
+    fingerprint = record.fingerprint;
+    return true;
+}
+
+bool commitBMSConfigToNVM(const BmsConfigImage& image) {
+    uint16_t words[BMS_CONFIG_MAX_REGISTERS];
+    I2C_Status status;
+    if (compareBMSConfigImage(image, words, status) != 0 || status != I2C_OK) {
+        Serial.println("Error: BMS registers do not match the configuration, not committing them to NVM.");
+        return false;
+    }
+
+    uint16_t fingerprint = bmsConfigFingerprint(image);
+    uint16_t committed;
+    if (getBMSNvmFingerprint(committed) && committed == fingerprint) {
+        Serial.println("BMS NVM already holds this configuration.");
+        return true;
+    }
+    if (!takeBMSNvmCommit(fingerprint)) {
+        return false;
+    }
+
+    bool conversionWasActive = (bmsConversionActive == 1);
+    writeBMSRegister(getBMSRegister(BMS_NVM_2_DL), (uint16_t)getBMSRegister(BMS_NVM_2_DL).fields[0].defaultValue);
+    delay(100); // Add a delay to ensure the command is processed
+    if (conversionWasActive) {
+        setBMSConversionState("CONVERSION_ON");
+    }
+    return true;
+}
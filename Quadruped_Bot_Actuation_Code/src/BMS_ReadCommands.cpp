@@ -19,41 +19,70 @@
 float TotalCoulombs= 0.0f; // Variable to store the total coulombs counted
 unsigned int TotalSampleCount = 0; // Variable to store the number of samples taken
 
+// Reads a measurement register, false if the L9961 did not answer
+static bool readMeasurement(uint8_t registerAddress, uint16_t& raw) {
+    return readBMSRegister(0x49, registerAddress, raw) == I2C_OK;
+}
+
+// Reads the two halves of a 32-bit identity field, 0 and the failing status if either read fails
+static uint32_t readIdentityPair(uint8_t msbRegister, I2C_Status* status) {
+    uint16_t msb = 0;
+    uint16_t lsb = 0;
+    I2C_Status result = readBMSRegister(0x49, msbRegister, msb);
+    if (result == I2C_OK) result = readBMSRegister(0x49, msbRegister + 1, lsb);
+    if (status) *status = result;
+    if (result != I2C_OK) return 0;
+    return ((uint32_t)msb << 16) | lsb;
+}
+
+static uint16_t readIdentityWord(uint8_t registerAddress, I2C_Status* status) {
+    uint16_t value = 0;
+    I2C_Status result = readBMSRegister(0x49, registerAddress, value);
+    if (status) *status = result;
+    return value;
+}
+
 
 //code to read cell voltages. 12bits across a range of 5V
 float readVCell1() {
-    uint16_t raw = readBMSData(0x49, 0x21);
+    uint16_t raw;
+    if (!readMeasurement(0x21, raw)) return NAN;
     uint16_t cellBits = raw & 0x0FFF; // 12 bits: mask with 0b0000111111111111
     return (cellBits / 4095.0f) * 5.0f; // 5V range
 }
 
 float readVCell2() {
-    uint16_t raw = readBMSData(0x49, 0x22);
+    uint16_t raw;
+    if (!readMeasurement(0x22, raw)) return NAN;
     uint16_t cellBits = raw & 0x0FFF;
     return (cellBits / 4095.0f) * 5.0f;
 }
 
 float readVCell3() {
-    uint16_t raw = readBMSData(0x49, 0x23);
+    uint16_t raw;
+    if (!readMeasurement(0x23, raw)) return NAN;
     uint16_t cellBits = raw & 0x0FFF;
     return (cellBits / 4095.0f) * 5.0f;
 }
 
 float readVCell4() {
-    uint16_t raw = readBMSData(0x49, 0x24);
+    uint16_t raw;
+    if (!readMeasurement(0x24, raw)) return NAN;
     uint16_t cellBits = raw & 0x0FFF;
     return (cellBits / 4095.0f) * 5.0f;
 }
 
 float readVCell5() {
-    uint16_t raw = readBMSData(0x49, 0x25);
+    uint16_t raw;
+    if (!readMeasurement(0x25, raw)) return NAN;
     uint16_t cellBits = raw & 0x0FFF;
     return (cellBits / 4095.0f) * 5.0f;
 }
 
 
 float readVCellSum() {
-    uint16_t raw = readBMSData(0x49, 0x26);
+    uint16_t raw;
+    if (!readMeasurement(0x26, raw)) return NAN;
     uint16_t sumBits = raw & 0x7FFF; // 15 bits: mask with 0b0111111111111111
     return (sumBits / 4095.0f) * 5.0f; // 25V range
 }
@@ -61,20 +90,23 @@ float readVCellSum() {
 
 
 float readVB() {
-    uint16_t raw = readBMSData(0x49, 0x27);
+    uint16_t raw;
+    if (!readMeasurement(0x27, raw)) return NAN;
     uint16_t vbBits = raw & 0x0FFF; // 12 bits: mask with 0b0000111111111111
     return (vbBits / 4095.0f) * 25.0f; // 25V range
 }
 
 
 float readNTC_GPIO() {
-    uint16_t raw = readBMSData(0x49, 0x28);
+    uint16_t raw;
+    if (!readMeasurement(0x28, raw)) return NAN;
     uint16_t ntcBits = raw & 0x0FFF; // 12 bits: mask with 0b0000111111111111
     return (ntcBits / 4095.0f) * 3.3f; // 3.3V range
 }
 
 float readDieTemp() {
-    uint16_t raw = readBMSData(0x49, 0x29);
+    uint16_t raw;
+    if (!readMeasurement(0x29, raw)) return NAN;
     uint16_t dieBits = raw & 0x0FFF; // 12 bits: mask with 0b0000111111111111
     // Formula: T = 343.165 - 0.196 * DIE_TEMP_MEAS
     return 343.165f - 0.196f * dieBits;
@@ -83,7 +115,8 @@ float readDieTemp() {
 
 
 float readCurrent() {
-    uint16_t raw = readBMSData(0x49, 0x2C); 
+    uint16_t raw;
+    if (!readMeasurement(0x2C, raw)) return NAN; 
     int16_t signedRaw = (int16_t)raw; // Interpret as signed 16-bit (two's complement)
 
     // Use your defined max voltage and sense resistor
@@ -102,8 +135,19 @@ CoulombCountResult readCoulombCounter() {
     writeBMSData(0x49, 0x2D, 0xFFFF); // Reset the Coulomb counter
 
 
-    uint16_t msb = readBMSData(0x49, 0x2D);      // 16 MSB
-    uint16_t lsb_and_count = readBMSData(0x49, 0x2E); // 8 MSB (accumulator), 8 LSB (sample count)
+    CoulombCountResult result;
+    uint16_t msb = 0;           // 16 MSB
+    uint16_t lsb_and_count = 0; // 8 MSB (accumulator), 8 LSB (sample count)
+    result.status = readBMSRegister(0x49, 0x2D, msb);
+    if (result.status == I2C_OK) result.status = readBMSRegister(0x49, 0x2E, lsb_and_count);
+    if (result.status != I2C_OK) {
+        // Nothing was counted, leave the totals as they were
+        result.coulombs = 0.0f;
+        result.sampleCount = 0;
+        result.totalCoulombs = TotalCoulombs;
+        result.totalSampleCount = TotalSampleCount;
+        return result;
+    }
 
     uint32_t acc24 = ((uint32_t)msb << 8) | (lsb_and_count >> 8); // 24 bits
     // Sign-extend if negative (two's complement)
@@ -121,8 +165,7 @@ CoulombCountResult readCoulombCounter() {
     TotalCoulombs += coulombs;
     TotalCoulombs = roundf(TotalCoulombs * 100.0f) / 100.0f; // Round to 2 decimal places
     TotalSampleCount += sampleCount;
-    
-    CoulombCountResult result;
+
     result.coulombs = coulombs;
     result.sampleCount = sampleCount;
     result.totalCoulombs = TotalCoulombs;
@@ -133,39 +176,122 @@ CoulombCountResult readCoulombCounter() {
     // Currently accurate to 0.005A over estimating sample. will need to test with larger load to see how much of an impact is causing.
 }
 
+// Mask and scale of the registers from 0x21 to 0x29, value = (raw & mask) * scale + offset
+struct MeasurementScale {
+    uint16_t mask;
+    float scale;
+    float offset;
+};
+
+static const MeasurementScale measurementScales[] = {
+    {0x0FFF, 5.0f / 4095.0f, 0.0f},   // VCELL1
+    {0x0FFF, 5.0f / 4095.0f, 0.0f},   // VCELL2
+    {0x0FFF, 5.0f / 4095.0f, 0.0f},   // VCELL3
+    {0x0FFF, 5.0f / 4095.0f, 0.0f},   // VCELL4
+    {0x0FFF, 5.0f / 4095.0f, 0.0f},   // VCELL5
+    {0x7FFF, 5.0f / 4095.0f, 0.0f},   // VCELLSUM
+    {0x0FFF, 25.0f / 4095.0f, 0.0f},  // VB
+    {0x0FFF, 3.3f / 4095.0f, 0.0f},   // NTC_GPIO
+    {0x0FFF, -0.196f, 343.165f},      // DIE_TEMP
+};
+
+#define BMS_SCALED_COUNT (sizeof(measurementScales) / sizeof(measurementScales[0]))
+
+void decodeBMSMeasurements(BmsMeasurements& measurements) {
+    const uint16_t* raw = measurements.raw;
+
+    // One multiply-add per register from the table, no branches, so the loop unrolls cleanly
+    float scaled[BMS_SCALED_COUNT];
+    for (uint8_t index = 0; index < BMS_SCALED_COUNT; index++) {
+        const MeasurementScale& entry = measurementScales[index];
+        scaled[index] = (raw[index] & entry.mask) * entry.scale + entry.offset;
+    }
+    for (uint8_t cell = 0; cell < BMS_CELL_COUNT; cell++) {
+        measurements.cellVoltage[cell] = scaled[cell];
+    }
+    measurements.cellSum = scaled[0x26 - BMS_MEASUREMENT_FIRST_REGISTER];
+    measurements.batteryVoltage = scaled[0x27 - BMS_MEASUREMENT_FIRST_REGISTER];
+    measurements.ntcVoltage = scaled[0x28 - BMS_MEASUREMENT_FIRST_REGISTER];
+    measurements.dieTemperature = scaled[0x29 - BMS_MEASUREMENT_FIRST_REGISTER];
+
+    measurements.diagOvOtUt = raw[0x2A - BMS_MEASUREMENT_FIRST_REGISTER];
+    measurements.diagUv = raw[0x2B - BMS_MEASUREMENT_FIRST_REGISTER];
+
+    int16_t signedCurrent = (int16_t)raw[0x2C - BMS_MEASUREMENT_FIRST_REGISTER];
+    measurements.current = (signedCurrent * (voltageLimitRangeExt / 32767.0f)) / senseResistor;
+
+    uint16_t msb = raw[0x2D - BMS_MEASUREMENT_FIRST_REGISTER];
+    uint16_t lsbAndCount = raw[0x2E - BMS_MEASUREMENT_FIRST_REGISTER];
+    uint32_t acc24 = ((uint32_t)msb << 8) | (lsbAndCount >> 8);
+    if (acc24 & 0x800000) acc24 |= 0xFF000000; // sign-extend the 24 bit accumulator
+    measurements.coulombAccumulator = (int32_t)acc24;
+    measurements.coulombSamples = lsbAndCount & 0xFF;
+}
+
+I2C_Status readBMSMeasurements(BmsMeasurements& measurements) {
+    I2C_Status status = readBMSBlock(0x49, BMS_MEASUREMENT_FIRST_REGISTER, measurements.raw, BMS_MEASUREMENT_COUNT);
+    decodeBMSMeasurements(measurements);
+    return status;
+}
+
+BmsBlockBenchmark benchmarkBMSBlockRead(uint8_t chipAddress, uint16_t iterations) {
+    BmsBlockBenchmark result = {iterations, 10, 0, 0, 0, 0};
+    const uint8_t blockCount = 0x2C - BMS_MEASUREMENT_FIRST_REGISTER + 1; // cells up to current
+    result.blockTransactions = L9961_AUTO_INCREMENT ? 1 : blockCount;
+    if (iterations == 0) {
+        return result;
+    }
+
+    // Keep the results live so none of the reads can be dropped
+    volatile float sink = 0.0f;
+
+    uint32_t start = micros();
+    for (uint16_t i = 0; i < iterations; i++) {
+        sink = readVCell1() + readVCell2() + readVCell3() + readVCell4() + readVCell5() +
+               readVCellSum() + readVB() + readNTC_GPIO() + readDieTemp() + readCurrent();
+    }
+    result.separateMicros = (micros() - start) / iterations;
+
+    BmsMeasurements measurements = {};
+    start = micros();
+    for (uint16_t i = 0; i < iterations; i++) {
+        readBMSBlock(chipAddress, BMS_MEASUREMENT_FIRST_REGISTER, measurements.raw, blockCount);
+        decodeBMSMeasurements(measurements);
+        sink = measurements.current;
+    }
+    result.blockMicros = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t i = 0; i < iterations; i++) {
+        decodeBMSMeasurements(measurements);
+        sink = measurements.current;
+    }
+    result.decodeMicros = (micros() - start) / iterations;
+    (void)sink;
+    return result;
+}
+
 // Manufacturer Name (32-bit, from 0x17 MSB and 0x18 LSB)
-uint32_t readManufacturerName() {
-    uint16_t msb = readBMSData(0x49, 0x17);
-    uint16_t lsb = readBMSData(0x49, 0x18);
-    return ((uint32_t)msb << 16) | lsb;
+uint32_t readManufacturerName(I2C_Status* status) {
+    return readIdentityPair(0x17, status);
 }
 
 // Manufacturer Date (16-bit, from 0x19)
-uint16_t readManufacturerDate() {
-    return readBMSData(0x49, 0x19);
+uint16_t readManufacturerDate(I2C_Status* status) {
+    return readIdentityWord(0x19, status);
 }
 
 // First Usage Date (16-bit, from 0x1A)
-uint16_t readFirstUsageDate() {
-    return readBMSData(0x49, 0x1A);
+uint16_t readFirstUsageDate(I2C_Status* status) {
+    return readIdentityWord(0x1A, status);
 }
 
 // Serial Number (32-bit, from 0x1B MSB and 0x1C LSB)
-uint32_t readSerialNumber() {
-    uint16_t msb = readBMSData(0x49, 0x1B);
-    uint16_t lsb = readBMSData(0x49, 0x1C);
-    return ((uint32_t)msb << 16) | lsb;
+uint32_t readSerialNumber(I2C_Status* status) {
+    return readIdentityPair(0x1B, status);
 }
 
 // Device Name (32-bit, from 0x1D MSB and 0x1E LSB)
-uint32_t readDeviceName() {
-    uint16_t msb = readBMSData(0x49, 0x1D);
-    uint16_t lsb = readBMSData(0x49, 0x1E);
-    return ((uint32_t)msb << 16) | lsb;
+uint32_t readDeviceName(I2C_Status* status) {
+    return readIdentityPair(0x1D, status);
 }
-
-
-
-
-
-// scope to add diagnostic failure messages.
\ No newline at end of file
@@ -0,0 +1,565 @@
+// BMS_Registers.cpp
+// -----------------
+// Implementation of the L9961 register descriptor table and the shared encode path.
+// The field layouts, limits and defaults are the ones the strcmp-based command functions used,
+// and testBMSRegisterEncodings() checks the encodings against values recorded from those functions.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include <limits.h>
+#include "BMS_Registers.h"
+
+// Shorthand for the table below, the command name is the id without its BMS_ prefix
+#define FIELD(shift, width, unit, min, max, defaultValue) {shift, width, unit, min, max, defaultValue}
+#define NO_FIELD {0, 0, BMS_UNIT_RAW, 0.0f, 0.0f, 0.0f}
+#define CONFIG_REGISTER(id, address, maxData, defaultData) \
+    {id, #id + 4, address, BMS_GROUP_CONFIG, 1, {FIELD(0, 16, BMS_UNIT_RAW, 0.0f, maxData, defaultData), NO_FIELD}}
+#define IDENTITY_REGISTER(id, address) \
+    {id, #id + 4, address, BMS_GROUP_IDENTITY, 1, {FIELD(0, 16, BMS_UNIT_RAW, 1.0f, 0xFFFF, 0.0f), NO_FIELD}}
+#define FIXED_COMMAND(id, group, address, data) \
+    {id, #id + 4, address, group, 0, {FIELD(0, 16, BMS_UNIT_RAW, 0.0f, 0xFFFF, data), NO_FIELD}}
+
+static constexpr BmsRegisterDescriptor bmsRegisters[] = {
+    CONFIG_REGISTER(BMS_CFG2_ENABLES, 0x04, 0x3FFF, 0x19FF),
+    CONFIG_REGISTER(BMS_TO_PRDV_BAL_MSK, 0x13, 0x7FFF, 0x7FFF),
+    CONFIG_REGISTER(BMS_TO_FUSE_RST_MSK, 0x14, 0x007F, 0x007F),
+    CONFIG_REGISTER(BMS_TO_FAULTN_MSK, 0x15, 0x0FFF, 0x0FFF),
+    CONFIG_REGISTER(BMS_CURR_MSK, 0x16, 0x0FFF, 0x0FFF),
+    CONFIG_REGISTER(BMS_DIAG_OV_OT_UT, 0x2A, 0xFFFF, 0x0000),
+    CONFIG_REGISTER(BMS_DIAG_UV, 0x2B, 0xFFFF, 0x0000),
+    CONFIG_REGISTER(BMS_DIAG_CURR, 0x2F, 0xFFFF, 0x0000),
+
+    IDENTITY_REGISTER(BMS_MANUFACTURE_NAME_MSB, 0x17),
+    IDENTITY_REGISTER(BMS_MANUFACTURE_NAME_LSB, 0x18),
+    IDENTITY_REGISTER(BMS_MANUFACTURING_DATE, 0x19),
+    IDENTITY_REGISTER(BMS_FIRST_USAGE_DATE, 0x1A),
+    IDENTITY_REGISTER(BMS_SERIAL_NUMBER_MSB, 0x1B),
+    IDENTITY_REGISTER(BMS_SERIAL_NUMBER_LSB, 0x1C),
+    IDENTITY_REGISTER(BMS_DEVICE_NAME_MSB, 0x1D),
+    IDENTITY_REGISTER(BMS_DEVICE_NAME_LSB, 0x1E),
+
+    // Defaults are the ones set in the numerical commands, change them here
+    {BMS_CSA_GAIN_FACTOR, "CSA_GAIN_FACTOR", 0x05, BMS_GROUP_NUMERICAL, 1, {
+        FIELD(0, 16, BMS_UNIT_RAW, 0.0f, 0xFFFF, 0x8000), NO_FIELD}},
+    // [0000][NCELL_OV_CNT_TH(4)][VCELL_OV_TH(8)]
+    {BMS_VCELL_OV_TH, "VCELL_OV_TH", 0x06, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VCELL, 0.0f, 5.0f, 4.3f), FIELD(8, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [0000][NCELL_UV_CNT_TH(4)][VCELL_UV_TH(8)]
+    {BMS_VCELL_UV_TH, "VCELL_UV_TH", 0x07, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VCELL, 0.0f, 5.0f, 2.2f), FIELD(8, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [UV_CODE(8)][OV_CODE(8)]
+    {BMS_VCELL_SEVERE_DELTA_THRS, "VCELL_SEVERE_DELTA_THRS", 0x08, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VCELL, 0.0f, 5.0f, 0.2f), FIELD(8, 8, BMS_UNIT_VCELL, 0.0f, 5.0f, 0.2f)}},
+    // [0000][NCELL_BAL_UV_CNT_TH(4)][VCELL_BAL_UV_DELTA_TH(8)]
+    {BMS_VCELL_BAL_UV_DELTA_TH, "VCELL_BAL_UV_DELTA_TH", 0x09, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VCELL, 0.0f, 5.0f, 0.2f), FIELD(8, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [0000][NCELL_OV_CNT_TH(4)][VB_OV_TH(8)]
+    {BMS_VB_OV_TH, "VB_OV_TH", 0x0A, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VB, 0.0f, 25.0f, 23.0f), FIELD(8, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [0000][NCELL_UV_CNT_TH(4)][VB_UV_TH(8)]
+    {BMS_VB_UV_TH, "VB_UV_TH", 0x0B, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_VB, 0.0f, 25.0f, 10.93f), FIELD(8, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [00000000][VB_SUM_MAX_DIFF_TH(8)]
+    {BMS_VB_SUM_MAX_DIFF_TH, "VB_SUM_MAX_DIFF_TH", 0x0C, BMS_GROUP_NUMERICAL, 1, {
+        FIELD(0, 8, BMS_UNIT_VB, 0.0f, 25.0f, 2.0f), NO_FIELD}},
+    // [NNTC_OT_CNT_TH(4)][NTC_OT_TH(12)]
+    {BMS_VNTC_OT_TH, "VNTC_OT_TH", 0x0D, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 12, BMS_UNIT_VNTC, 0.2f, 3.3f, 2.5f), FIELD(12, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [NNTC_UT_CNT_TH(4)][NTC_UT_TH(12)]
+    {BMS_VNTC_UT_TH, "VNTC_UT_TH", 0x0E, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 12, BMS_UNIT_VNTC, 0.0f, 3.3f, 0.5f), FIELD(12, 4, BMS_UNIT_COUNT, 1.0f, 15.0f, 15.0f)}},
+    // [0000][NTC_SEVERE_OT_DELTA_TH(12)]
+    {BMS_VNTC_SEVERE_OT_DELTA_TH, "VNTC_SEVERE_OT_DELTA_TH", 0x0F, BMS_GROUP_NUMERICAL, 1, {
+        FIELD(0, 12, BMS_UNIT_VNTC, 0.0f, 3.3f, 0.5f), NO_FIELD}},
+    // [OVC_DCHG_TH(8)][OVC_CHG_TH(8)]
+    {BMS_OVC_THRESHOLDS, "OVC_THRESHOLDS", 0x10, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 8, BMS_UNIT_IMAX, 0.0f, 1.0f, 1.0f), FIELD(8, 8, BMS_UNIT_IMAX, 0.0f, 1.0f, 1.0f)}},
+    // [00000000][CODE(8)]
+    {BMS_PERSISTENT_OVC_THRESHOLDS, "PERSISTENT_OVC_THRESHOLDS", 0x11, BMS_GROUP_NUMERICAL, 1, {
+        FIELD(0, 8, BMS_UNIT_IMAX, 0.0f, 1.0f, 1.0f), NO_FIELD}},
+    // [00000000][SC_PERSIST_TH(4)][SC_TH(4)]
+    {BMS_SC_THRESHOLD, "SC_THRESHOLD", 0x12, BMS_GROUP_NUMERICAL, 2, {
+        FIELD(0, 4, BMS_UNIT_SC, 0.0f, 1000.0f, 100.0f), FIELD(4, 4, BMS_UNIT_SC, 0.0f, 1000.0f, 100.0f)}},
+
+    FIXED_COMMAND(BMS_BAL_ENABLE, BMS_GROUP_REALTIME, 0x01, 0x001F),  // balancing on
+    FIXED_COMMAND(BMS_BAL_DISABLE, BMS_GROUP_REALTIME, 0x01, 0x0000), // balancing off
+    FIXED_COMMAND(BMS_GO2SHIP, BMS_GROUP_REALTIME, 0x21, 0x2000),     // ship mode, low power
+    FIXED_COMMAND(BMS_GO2STBY, BMS_GROUP_REALTIME, 0x22, 0x2000),     // standby mode, low power
+    FIXED_COMMAND(BMS_FUSE_TRIG_DISARM, BMS_GROUP_REALTIME, 0x23, 0x1000),
+    FIXED_COMMAND(BMS_FUSE_TRIG_ARM, BMS_GROUP_REALTIME, 0x23, 0x2000),
+    FIXED_COMMAND(BMS_FUSE_TRIG_FIRE_INTERRUPT, BMS_GROUP_REALTIME, 0x24, 0x1000), // stops the fuse firing
+    FIXED_COMMAND(BMS_FUSE_TRIG_FIRE, BMS_GROUP_REALTIME, 0x24, 0x2000),           // fires the fuse
+
+    FIXED_COMMAND(BMS_NVM_2_DL, BMS_GROUP_NVM, 0x20, 0xAAAA), // commits I2C to NVM, only 32 times in the device's life
+    FIXED_COMMAND(BMS_NVM_2_UL, BMS_GROUP_NVM, 0x20, 0x5555), // loads NVM into the I2C registers
+};
+
+static_assert(sizeof(bmsRegisters) / sizeof(bmsRegisters[0]) == BMS_REGISTER_COUNT,
+              "One descriptor per BmsRegisterId");
+
+static constexpr bool tableInOrder(uint8_t index = 0) {
+    return index == BMS_REGISTER_COUNT || (bmsRegisters[index].id == index && tableInOrder(index + 1));
+}
+static_assert(tableInOrder(), "Descriptors must be in BmsRegisterId order");
+
+
+// 32 bit FNV-1a hash of a command name
+static constexpr uint32_t nameHash(const char* text, uint32_t hash = 2166136261u) {
+    return *text ? nameHash(text + 1, (hash ^ (uint8_t)*text) * 16777619u) : hash;
+}
+
+static constexpr uint32_t registerHash(BmsRegisterId id) {
+    return nameHash(bmsRegisters[id].name);
+}
+
+// Two names with the same hash would make duplicate case labels, so the switch is a compile-time
+// proof that the hash is perfect over the table
+static BmsRegisterId idFromHash(uint32_t hash) {
+    switch (hash) {
+        case registerHash(BMS_CFG2_ENABLES): return BMS_CFG2_ENABLES;
+        case registerHash(BMS_TO_PRDV_BAL_MSK): return BMS_TO_PRDV_BAL_MSK;
+        case registerHash(BMS_TO_FUSE_RST_MSK): return BMS_TO_FUSE_RST_MSK;
+        case registerHash(BMS_TO_FAULTN_MSK): return BMS_TO_FAULTN_MSK;
+        case registerHash(BMS_CURR_MSK): return BMS_CURR_MSK;
+        case registerHash(BMS_DIAG_OV_OT_UT): return BMS_DIAG_OV_OT_UT;
+        case registerHash(BMS_DIAG_UV): return BMS_DIAG_UV;
+        case registerHash(BMS_DIAG_CURR): return BMS_DIAG_CURR;
+        case registerHash(BMS_MANUFACTURE_NAME_MSB): return BMS_MANUFACTURE_NAME_MSB;
+        case registerHash(BMS_MANUFACTURE_NAME_LSB): return BMS_MANUFACTURE_NAME_LSB;
+        case registerHash(BMS_MANUFACTURING_DATE): return BMS_MANUFACTURING_DATE;
+        case registerHash(BMS_FIRST_USAGE_DATE): return BMS_FIRST_USAGE_DATE;
+        case registerHash(BMS_SERIAL_NUMBER_MSB): return BMS_SERIAL_NUMBER_MSB;
+        case registerHash(BMS_SERIAL_NUMBER_LSB): return BMS_SERIAL_NUMBER_LSB;
+        case registerHash(BMS_DEVICE_NAME_MSB): return BMS_DEVICE_NAME_MSB;
+        case registerHash(BMS_DEVICE_NAME_LSB): return BMS_DEVICE_NAME_LSB;
+        case registerHash(BMS_CSA_GAIN_FACTOR): return BMS_CSA_GAIN_FACTOR;
+        case registerHash(BMS_VCELL_OV_TH): return BMS_VCELL_OV_TH;
+        case registerHash(BMS_VCELL_UV_TH): return BMS_VCELL_UV_TH;
+        case registerHash(BMS_VCELL_SEVERE_DELTA_THRS): return BMS_VCELL_SEVERE_DELTA_THRS;
+        case registerHash(BMS_VCELL_BAL_UV_DELTA_TH): return BMS_VCELL_BAL_UV_DELTA_TH;
+        case registerHash(BMS_VB_OV_TH): return BMS_VB_OV_TH;
+        case registerHash(BMS_VB_UV_TH): return BMS_VB_UV_TH;
+        case registerHash(BMS_VB_SUM_MAX_DIFF_TH): return BMS_VB_SUM_MAX_DIFF_TH;
+        case registerHash(BMS_VNTC_OT_TH): return BMS_VNTC_OT_TH;
+        case registerHash(BMS_VNTC_UT_TH): return BMS_VNTC_UT_TH;
+        case registerHash(BMS_VNTC_SEVERE_OT_DELTA_TH): return BMS_VNTC_SEVERE_OT_DELTA_TH;
+        case registerHash(BMS_OVC_THRESHOLDS): return BMS_OVC_THRESHOLDS;
+        case registerHash(BMS_PERSISTENT_OVC_THRESHOLDS): return BMS_PERSISTENT_OVC_THRESHOLDS;
+        case registerHash(BMS_SC_THRESHOLD): return BMS_SC_THRESHOLD;
+        case registerHash(BMS_BAL_ENABLE): return BMS_BAL_ENABLE;
+        case registerHash(BMS_BAL_DISABLE): return BMS_BAL_DISABLE;
+        case registerHash(BMS_GO2SHIP): return BMS_GO2SHIP;
+        case registerHash(BMS_GO2STBY): return BMS_GO2STBY;
+        case registerHash(BMS_FUSE_TRIG_DISARM): return BMS_FUSE_TRIG_DISARM;
+        case registerHash(BMS_FUSE_TRIG_ARM): return BMS_FUSE_TRIG_ARM;
+        case registerHash(BMS_FUSE_TRIG_FIRE_INTERRUPT): return BMS_FUSE_TRIG_FIRE_INTERRUPT;
+        case registerHash(BMS_FUSE_TRIG_FIRE): return BMS_FUSE_TRIG_FIRE;
+        case registerHash(BMS_NVM_2_DL): return BMS_NVM_2_DL;
+        case registerHash(BMS_NVM_2_UL): return BMS_NVM_2_UL;
+        default: return BMS_REGISTER_COUNT;
+    }
+}
+
+
+// Integer argument, clamped. Returns INT_MIN for "default", min for a missing argument.
+static int parseIntArg(const char* arg, int minVal, int maxVal) {
+    if (!arg) return minVal;
+    if (strcasecmp(arg, "max") == 0) return maxVal;
+    if (strcasecmp(arg, "min") == 0) return minVal;
+    if (strcasecmp(arg, "default") == 0) return INT_MIN; // Sentinel for default
+    long val = strtol(arg, nullptr, 10);
+    if (val < minVal) return minVal;
+    if (val > maxVal) return maxVal;
+    return (int)val;
+}
+
+// Float argument, clamped. Returns NAN for "default", min for a missing argument.
+static float parseFloatArg(const char* arg, float minVal, float maxVal) {
+    if (!arg) return minVal;
+    if (strcasecmp(arg, "max") == 0) return maxVal;
+    if (strcasecmp(arg, "min") == 0) return minVal;
+    if (strcasecmp(arg, "default") == 0) return NAN; // Sentinel for default
+    float val = atof(arg);
+    if (val < minVal) return minVal;
+    if (val > maxVal) return maxVal;
+    return val;
+}
+
+// Code of a value in real units, before it is clamped to the field
+static int unitCode(BmsUnit unit, float value) {
+    switch (unit) {
+        case BMS_UNIT_VCELL:
+            return (int)((value / (16 * VCELL_RES)) + 0.5f);
+        case BMS_UNIT_VB:
+            return (int)((value / (16 * VB_RES)) + 0.5f);
+        case BMS_UNIT_VNTC:
+            return (int)((value / VNTC_RES) + 0.5f);
+        case BMS_UNIT_IMAX:
+            return (int)((value / Imax) * 255.0f + 0.5f);
+        case BMS_UNIT_SC: {
+            // The comparator runs from 49.14mV in 15 steps of 14.04mV across the sense resistor
+            float minVoltage = 0.04914f;
+            float maxVoltage = 0.04914f + 0.01404f * 15.0f; // 0.26074V
+            float minCurrent = minVoltage / senseResistor;
+            float maxCurrent = maxVoltage / senseResistor;
+            if (value < minCurrent) value = minCurrent;
+            if (value > maxCurrent) value = maxCurrent;
+            float voltage = value * senseResistor;
+            return (int)(((voltage - 0.04914f) / 0.01404f) + 0.5f);
+        }
+        default:
+            return (int)value;
+    }
+}
+
+// Encodes one numerical argument into its place in the register
+static uint16_t encodeField(const BmsField& field, const char* arg) {
+    int code;
+    if (field.unit == BMS_UNIT_RAW || field.unit == BMS_UNIT_COUNT) {
+        code = parseIntArg(arg, (int)field.min, (int)field.max);
+        if (code == INT_MIN) code = (int)field.defaultValue;
+    } else {
+        float fullScale = (field.unit == BMS_UNIT_IMAX) ? Imax : 1.0f;
+        float value = parseFloatArg(arg, field.min * fullScale, field.max * fullScale);
+        if (isnan(value)) value = field.defaultValue * fullScale;
+        code = unitCode(field.unit, value);
+    }
+
+    int mask = (1 << field.width) - 1;
+    if (code < 0) code = 0;
+    if (code > mask) code = mask;
+    return (uint16_t)(code << field.shift);
+}
+
+
+const BmsRegisterDescriptor* findBMSRegister(const char* name) {
+    BmsRegisterId id = idFromHash(nameHash(name));
+    if (id == BMS_REGISTER_COUNT || strcmp(bmsRegisters[id].name, name) != 0) {
+        return nullptr; // unknown, or a different name that happens to share a hash
+    }
+    return &bmsRegisters[id];
+}
+
+const BmsRegisterDescriptor& getBMSRegister(BmsRegisterId id) {
+    return bmsRegisters[id];
+}
+
+BmsEncodeStatus encodeBMSCommand(const BmsRegisterDescriptor& reg, const char* arg1, const char* arg2, uint16_t& data) {
+    const BmsField& first = reg.fields[0];
+
+    switch (reg.group) {
+        case BMS_GROUP_CONFIG:
+            if (arg1 && strcmp(arg1, "default") == 0) {
+                data = (uint16_t)first.defaultValue;
+                return BMS_ENCODE_OK;
+            }
+            if (arg1 && strncmp(arg1, "0b", 2) == 0) {
+                data = (uint16_t)strtol(arg1 + 2, nullptr, 2);
+                if (data > first.max) {
+                    data = (uint16_t)first.max;
+                    return BMS_ENCODE_CAPPED;
+                }
+                return BMS_ENCODE_OK;
+            }
+            return BMS_ENCODE_INVALID;
+
+        case BMS_GROUP_IDENTITY: {
+            // Identity values are never 0x0000, so a blank register shows the NVM was not loaded
+            long value = arg1 ? strtol(arg1, nullptr, 0) : 0;
+            if (value < first.min || value > first.max) {
+                return BMS_ENCODE_INVALID;
+            }
+            data = (uint16_t)value;
+            return BMS_ENCODE_OK;
+        }
+
+        case BMS_GROUP_NUMERICAL: {
+            const char* args[BMS_MAX_FIELDS] = {arg1, arg2};
+            data = 0;
+            for (uint8_t field = 0; field < reg.fieldCount; field++) {
+                data |= encodeField(reg.fields[field], args[field]);
+            }
+            return BMS_ENCODE_OK;
+        }
+
+        default:
+            data = (uint16_t)first.defaultValue;
+            return BMS_ENCODE_OK;
+    }
+}
+
+uint16_t getBMSWritableMask(const BmsRegisterDescriptor& reg) {
+    switch (reg.group) {
+        case BMS_GROUP_CONFIG:
+            return (uint16_t)reg.fields[0].max;
+        case BMS_GROUP_IDENTITY:
+            return 0xFFFF;
+        case BMS_GROUP_NUMERICAL: {
+            uint16_t mask = 0;
+            for (uint8_t field = 0; field < reg.fieldCount; field++) {
+                mask |= ((1 << reg.fields[field].width) - 1) << reg.fields[field].shift;
+            }
+            return mask;
+        }
+        default:
+            return 0;
+    }
+}
+
+void writeBMSRegister(const BmsRegisterDescriptor& reg, uint16_t data) {
+    //Checks if conversion is active and if so turns it off.
+    if (bmsConversionActive == 1) {
+        setBMSConversionState("CONVERSION_OFF");
+    }
+    writeBMSData(0x49, reg.address, data);
+}
+
+
+// Address and value each command produced through the strcmp-based functions, with the defaults in
+// the table and an 8mΩ sense resistor
+struct BmsGoldenCase {
+    const char* command;
+    const char* arg1;
+    const char* arg2;
+    uint8_t address;
+    uint16_t data;
+};
+
+static const BmsGoldenCase goldenCases[] = {
+    {"CSA_GAIN_FACTOR", "default", "default", 0x05, 0x8000},
+    {"CSA_GAIN_FACTOR", "min", "min", 0x05, 0x0000},
+    {"CSA_GAIN_FACTOR", "max", "max", 0x05, 0xFFFF},
+    {"CSA_GAIN_FACTOR", "MAX", "Min", 0x05, 0xFFFF},
+    {"CSA_GAIN_FACTOR", "max", nullptr, 0x05, 0xFFFF},
+    {"CSA_GAIN_FACTOR", "default", nullptr, 0x05, 0x8000},
+    {"CSA_GAIN_FACTOR", "12345", nullptr, 0x05, 0x3039},
+    {"CSA_GAIN_FACTOR", "-3", "99", 0x05, 0x0000},
+    {"CSA_GAIN_FACTOR", "70000", "0", 0x05, 0xFFFF},
+    {"CSA_GAIN_FACTOR", "100", "-5", 0x05, 0x0064},
+    {"CSA_GAIN_FACTOR", "", "", 0x05, 0x0000},
+    {"VCELL_OV_TH", "default", "default", 0x06, 0x0FDC},
+    {"VCELL_OV_TH", "min", "min", 0x06, 0x0100},
+    {"VCELL_OV_TH", "max", "max", 0x06, 0x0FFF},
+    {"VCELL_OV_TH", "MAX", "Min", 0x06, 0x01FF},
+    {"VCELL_OV_TH", "max", nullptr, 0x06, 0x01FF},
+    {"VCELL_OV_TH", "default", nullptr, 0x06, 0x01DC},
+    {"VCELL_OV_TH", "4.2", "10", 0x06, 0x0AD7},
+    {"VCELL_OV_TH", "-3", "99", 0x06, 0x0F00},
+    {"VCELL_OV_TH", "70000", "0", 0x06, 0x01FF},
+    {"VCELL_OV_TH", "100", "-5", 0x06, 0x01FF},
+    {"VCELL_OV_TH", "", "", 0x06, 0x0100},
+    {"VCELL_UV_TH", "default", "default", 0x07, 0x0F71},
+    {"VCELL_UV_TH", "min", "min", 0x07, 0x0100},
+    {"VCELL_UV_TH", "max", "max", 0x07, 0x0FFF},
+    {"VCELL_UV_TH", "MAX", "Min", 0x07, 0x01FF},
+    {"VCELL_UV_TH", "max", nullptr, 0x07, 0x01FF},
+    {"VCELL_UV_TH", "default", nullptr, 0x07, 0x0171},
+    {"VCELL_UV_TH", "2.7", "3", 0x07, 0x038A},
+    {"VCELL_UV_TH", "-3", "99", 0x07, 0x0F00},
+    {"VCELL_UV_TH", "70000", "0", 0x07, 0x01FF},
+    {"VCELL_UV_TH", "100", "-5", 0x07, 0x01FF},
+    {"VCELL_UV_TH", "", "", 0x07, 0x0100},
+    {"VCELL_SEVERE_DELTA_THRS", "default", "default", 0x08, 0x0A0A},
+    {"VCELL_SEVERE_DELTA_THRS", "min", "min", 0x08, 0x0000},
+    {"VCELL_SEVERE_DELTA_THRS", "max", "max", 0x08, 0xFFFF},
+    {"VCELL_SEVERE_DELTA_THRS", "MAX", "Min", 0x08, 0x00FF},
+    {"VCELL_SEVERE_DELTA_THRS", "max", nullptr, 0x08, 0x00FF},
+    {"VCELL_SEVERE_DELTA_THRS", "default", nullptr, 0x08, 0x000A},
+    {"VCELL_SEVERE_DELTA_THRS", "0.31", "0.13", 0x08, 0x0710},
+    {"VCELL_SEVERE_DELTA_THRS", "-3", "99", 0x08, 0xFF00},
+    {"VCELL_SEVERE_DELTA_THRS", "70000", "0", 0x08, 0x00FF},
+    {"VCELL_SEVERE_DELTA_THRS", "100", "-5", 0x08, 0x00FF},
+    {"VCELL_SEVERE_DELTA_THRS", "", "", 0x08, 0x0000},
+    {"VCELL_BAL_UV_DELTA_TH", "default", "default", 0x09, 0x0F0A},
+    {"VCELL_BAL_UV_DELTA_TH", "min", "min", 0x09, 0x0100},
+    {"VCELL_BAL_UV_DELTA_TH", "max", "max", 0x09, 0x0FFF},
+    {"VCELL_BAL_UV_DELTA_TH", "MAX", "Min", 0x09, 0x01FF},
+    {"VCELL_BAL_UV_DELTA_TH", "max", nullptr, 0x09, 0x01FF},
+    {"VCELL_BAL_UV_DELTA_TH", "default", nullptr, 0x09, 0x010A},
+    {"VCELL_BAL_UV_DELTA_TH", "0.05", "7", 0x09, 0x0703},
+    {"VCELL_BAL_UV_DELTA_TH", "-3", "99", 0x09, 0x0F00},
+    {"VCELL_BAL_UV_DELTA_TH", "70000", "0", 0x09, 0x01FF},
+    {"VCELL_BAL_UV_DELTA_TH", "100", "-5", 0x09, 0x01FF},
+    {"VCELL_BAL_UV_DELTA_TH", "", "", 0x09, 0x0100},
+    {"VB_OV_TH", "default", "default", 0x0A, 0x0FEC},
+    {"VB_OV_TH", "min", "min", 0x0A, 0x0100},
+    {"VB_OV_TH", "max", "max", 0x0A, 0x0FFF},
+    {"VB_OV_TH", "MAX", "Min", 0x0A, 0x01FF},
+    {"VB_OV_TH", "max", nullptr, 0x0A, 0x01FF},
+    {"VB_OV_TH", "default", nullptr, 0x0A, 0x01EC},
+    {"VB_OV_TH", "21", "12", 0x0A, 0x0CD7},
+    {"VB_OV_TH", "-3", "99", 0x0A, 0x0F00},
+    {"VB_OV_TH", "70000", "0", 0x0A, 0x01FF},
+    {"VB_OV_TH", "100", "-5", 0x0A, 0x01FF},
+    {"VB_OV_TH", "", "", 0x0A, 0x0100},
+    {"VB_UV_TH", "default", "default", 0x0B, 0x0F70},
+    {"VB_UV_TH", "min", "min", 0x0B, 0x0100},
+    {"VB_UV_TH", "max", "max", 0x0B, 0x0FFF},
+    {"VB_UV_TH", "MAX", "Min", 0x0B, 0x01FF},
+    {"VB_UV_TH", "max", nullptr, 0x0B, 0x01FF},
+    {"VB_UV_TH", "default", nullptr, 0x0B, 0x0170},
+    {"VB_UV_TH", "12.6", "2", 0x0B, 0x0281},
+    {"VB_UV_TH", "-3", "99", 0x0B, 0x0F00},
+    {"VB_UV_TH", "70000", "0", 0x0B, 0x01FF},
+    {"VB_UV_TH", "100", "-5", 0x0B, 0x01FF},
+    {"VB_UV_TH", "", "", 0x0B, 0x0100},
+    {"VB_SUM_MAX_DIFF_TH", "default", "default", 0x0C, 0x0014},
+    {"VB_SUM_MAX_DIFF_TH", "min", "min", 0x0C, 0x0000},
+    {"VB_SUM_MAX_DIFF_TH", "max", "max", 0x0C, 0x00FF},
+    {"VB_SUM_MAX_DIFF_TH", "MAX", "Min", 0x0C, 0x00FF},
+    {"VB_SUM_MAX_DIFF_TH", "max", nullptr, 0x0C, 0x00FF},
+    {"VB_SUM_MAX_DIFF_TH", "default", nullptr, 0x0C, 0x0014},
+    {"VB_SUM_MAX_DIFF_TH", "1.3", nullptr, 0x0C, 0x000D},
+    {"VB_SUM_MAX_DIFF_TH", "-3", "99", 0x0C, 0x0000},
+    {"VB_SUM_MAX_DIFF_TH", "70000", "0", 0x0C, 0x00FF},
+    {"VB_SUM_MAX_DIFF_TH", "100", "-5", 0x0C, 0x00FF},
+    {"VB_SUM_MAX_DIFF_TH", "", "", 0x0C, 0x0000},
+    {"VNTC_OT_TH", "default", "default", 0x0D, 0xFC1E},
+    {"VNTC_OT_TH", "min", "min", 0x0D, 0x10F8},
+    {"VNTC_OT_TH", "max", "max", 0x0D, 0xFFFE},
+    {"VNTC_OT_TH", "MAX", "Min", 0x0D, 0x1FFE},
+    {"VNTC_OT_TH", "max", nullptr, 0x0D, 0x1FFE},
+    {"VNTC_OT_TH", "default", nullptr, 0x0D, 0x1C1E},
+    {"VNTC_OT_TH", "1.9", "4", 0x0D, 0x4935},
+    {"VNTC_OT_TH", "-3", "99", 0x0D, 0xF0F8},
+    {"VNTC_OT_TH", "70000", "0", 0x0D, 0x1FFE},
+    {"VNTC_OT_TH", "100", "-5", 0x0D, 0x1FFE},
+    {"VNTC_OT_TH", "", "", 0x0D, 0x10F8},
+    {"VNTC_UT_TH", "default", "default", 0x0E, 0xF26C},
+    {"VNTC_UT_TH", "min", "min", 0x0E, 0x1000},
+    {"VNTC_UT_TH", "max", "max", 0x0E, 0xFFFE},
+    {"VNTC_UT_TH", "MAX", "Min", 0x0E, 0x1FFE},
+    {"VNTC_UT_TH", "max", nullptr, 0x0E, 0x1FFE},
+    {"VNTC_UT_TH", "default", nullptr, 0x0E, 0x126C},
+    {"VNTC_UT_TH", "0.7", "9", 0x0E, 0x9364},
+    {"VNTC_UT_TH", "-3", "99", 0x0E, 0xF000},
+    {"VNTC_UT_TH", "70000", "0", 0x0E, 0x1FFE},
+    {"VNTC_UT_TH", "100", "-5", 0x0E, 0x1FFE},
+    {"VNTC_UT_TH", "", "", 0x0E, 0x1000},
+    {"VNTC_SEVERE_OT_DELTA_TH", "default", "default", 0x0F, 0x026C},
+    {"VNTC_SEVERE_OT_DELTA_TH", "min", "min", 0x0F, 0x0000},
+    {"VNTC_SEVERE_OT_DELTA_TH", "max", "max", 0x0F, 0x0FFE},
+    {"VNTC_SEVERE_OT_DELTA_TH", "MAX", "Min", 0x0F, 0x0FFE},
+    {"VNTC_SEVERE_OT_DELTA_TH", "max", nullptr, 0x0F, 0x0FFE},
+    {"VNTC_SEVERE_OT_DELTA_TH", "default", nullptr, 0x0F, 0x026C},
+    {"VNTC_SEVERE_OT_DELTA_TH", "0.45", nullptr, 0x0F, 0x022E},
+    {"VNTC_SEVERE_OT_DELTA_TH", "-3", "99", 0x0F, 0x0000},
+    {"VNTC_SEVERE_OT_DELTA_TH", "70000", "0", 0x0F, 0x0FFE},
+    {"VNTC_SEVERE_OT_DELTA_TH", "100", "-5", 0x0F, 0x0FFE},
+    {"VNTC_SEVERE_OT_DELTA_TH", "", "", 0x0F, 0x0000},
+    {"OVC_THRESHOLDS", "default", "default", 0x10, 0xFFFF},
+    {"OVC_THRESHOLDS", "min", "min", 0x10, 0x0000},
+    {"OVC_THRESHOLDS", "max", "max", 0x10, 0xFFFF},
+    {"OVC_THRESHOLDS", "MAX", "Min", 0x10, 0x00FF},
+    {"OVC_THRESHOLDS", "max", nullptr, 0x10, 0x00FF},
+    {"OVC_THRESHOLDS", "default", nullptr, 0x10, 0x00FF},
+    {"OVC_THRESHOLDS", "20", "30", 0x10, 0xCC88},
+    {"OVC_THRESHOLDS", "-3", "99", 0x10, 0xFF00},
+    {"OVC_THRESHOLDS", "70000", "0", 0x10, 0x00FF},
+    {"OVC_THRESHOLDS", "100", "-5", 0x10, 0x00FF},
+    {"OVC_THRESHOLDS", "", "", 0x10, 0x0000},
+    {"PERSISTENT_OVC_THRESHOLDS", "default", "default", 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "min", "min", 0x11, 0x0000},
+    {"PERSISTENT_OVC_THRESHOLDS", "max", "max", 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "MAX", "Min", 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "max", nullptr, 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "default", nullptr, 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "12.3", nullptr, 0x11, 0x0054},
+    {"PERSISTENT_OVC_THRESHOLDS", "-3", "99", 0x11, 0x0000},
+    {"PERSISTENT_OVC_THRESHOLDS", "70000", "0", 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "100", "-5", 0x11, 0x00FF},
+    {"PERSISTENT_OVC_THRESHOLDS", "", "", 0x11, 0x0000},
+    {"SC_THRESHOLD", "default", "default", 0x12, 0x00FF},
+    {"SC_THRESHOLD", "min", "min", 0x12, 0x0000},
+    {"SC_THRESHOLD", "max", "max", 0x12, 0x00FF},
+    {"SC_THRESHOLD", "MAX", "Min", 0x12, 0x000F},
+    {"SC_THRESHOLD", "max", nullptr, 0x12, 0x000F},
+    {"SC_THRESHOLD", "default", nullptr, 0x12, 0x000F},
+    {"SC_THRESHOLD", "9", "25", 0x12, 0x00B2},
+    {"SC_THRESHOLD", "-3", "99", 0x12, 0x00F0},
+    {"SC_THRESHOLD", "70000", "0", 0x12, 0x000F},
+    {"SC_THRESHOLD", "100", "-5", 0x12, 0x000F},
+    {"SC_THRESHOLD", "", "", 0x12, 0x0000},
+    {"CFG2_ENABLES", "default", nullptr, 0x04, 0x19FF},
+    {"CFG2_ENABLES", "0b101", nullptr, 0x04, 0x0005},
+    {"CFG2_ENABLES", "0b1111111111111111", nullptr, 0x04, 0x3FFF},
+    {"TO_PRDV_BAL_MSK", "default", nullptr, 0x13, 0x7FFF},
+    {"TO_PRDV_BAL_MSK", "0b101", nullptr, 0x13, 0x0005},
+    {"TO_PRDV_BAL_MSK", "0b1111111111111111", nullptr, 0x13, 0x7FFF},
+    {"TO_FUSE_RST_MSK", "default", nullptr, 0x14, 0x007F},
+    {"TO_FUSE_RST_MSK", "0b101", nullptr, 0x14, 0x0005},
+    {"TO_FUSE_RST_MSK", "0b1111111111111111", nullptr, 0x14, 0x007F},
+    {"TO_FAULTN_MSK", "default", nullptr, 0x15, 0x0FFF},
+    {"TO_FAULTN_MSK", "0b101", nullptr, 0x15, 0x0005},
+    {"TO_FAULTN_MSK", "0b1111111111111111", nullptr, 0x15, 0x0FFF},
+    {"CURR_MSK", "default", nullptr, 0x16, 0x0FFF},
+    {"CURR_MSK", "0b101", nullptr, 0x16, 0x0005},
+    {"CURR_MSK", "0b1111111111111111", nullptr, 0x16, 0x0FFF},
+    {"DIAG_OV_OT_UT", "default", nullptr, 0x2A, 0x0000},
+    {"DIAG_OV_OT_UT", "0b101", nullptr, 0x2A, 0x0005},
+    {"DIAG_OV_OT_UT", "0b1111111111111111", nullptr, 0x2A, 0xFFFF},
+    {"DIAG_UV", "default", nullptr, 0x2B, 0x0000},
+    {"DIAG_UV", "0b101", nullptr, 0x2B, 0x0005},
+    {"DIAG_UV", "0b1111111111111111", nullptr, 0x2B, 0xFFFF},
+    {"DIAG_CURR", "default", nullptr, 0x2F, 0x0000},
+    {"DIAG_CURR", "0b101", nullptr, 0x2F, 0x0005},
+    {"DIAG_CURR", "0b1111111111111111", nullptr, 0x2F, 0xFFFF},
+    {"BAL_ENABLE", nullptr, nullptr, 0x01, 0x001F},
+    {"BAL_DISABLE", nullptr, nullptr, 0x01, 0x0000},
+    {"GO2SHIP", nullptr, nullptr, 0x21, 0x2000},
+    {"GO2STBY", nullptr, nullptr, 0x22, 0x2000},
+    {"FUSE_TRIG_DISARM", nullptr, nullptr, 0x23, 0x1000},
+    {"FUSE_TRIG_ARM", nullptr, nullptr, 0x23, 0x2000},
+    {"FUSE_TRIG_FIRE_INTERRUPT", nullptr, nullptr, 0x24, 0x1000},
+    {"FUSE_TRIG_FIRE", nullptr, nullptr, 0x24, 0x2000},
+    {"MANUFACTURE_NAME_MSB", "0x1111", nullptr, 0x17, 0x1111},
+    {"MANUFACTURE_NAME_LSB", "0x2222", nullptr, 0x18, 0x2222},
+    {"MANUFACTURING_DATE", "0x3333", nullptr, 0x19, 0x3333},
+    {"FIRST_USAGE_DATE", "0x4444", nullptr, 0x1A, 0x4444},
+    {"SERIAL_NUMBER_MSB", "0x5555", nullptr, 0x1B, 0x5555},
+    {"SERIAL_NUMBER_LSB", "0x6666", nullptr, 0x1C, 0x6666},
+    {"DEVICE_NAME_MSB", "0x7777", nullptr, 0x1D, 0x7777},
+    {"DEVICE_NAME_LSB", "0x8888", nullptr, 0x1E, 0x8888},
+    {"NVM_2_DL", nullptr, nullptr, 0x20, 0xAAAA},
+    {"NVM_2_UL", nullptr, nullptr, 0x20, 0x5555},
+};
+
+BmsEncodingTest testBMSRegisterEncodings() {
+    const uint16_t caseCount = sizeof(goldenCases) / sizeof(goldenCases[0]);
+    BmsEncodingTest result = {caseCount, 0, -1, false};
+
+    // Current thresholds scale with the sense resistor, encode them at the one the cases were recorded with
+    float savedSenseResistor = senseResistor;
+    float savedImax = Imax;
+    senseResistor = 0.008f;
+    Imax = voltageLimitRangeExt / senseResistor;
+
+    for (uint16_t index = 0; index < caseCount; index++) {
+        const BmsGoldenCase& golden = goldenCases[index];
+        const BmsRegisterDescriptor* reg = findBMSRegister(golden.command);
+        uint16_t data = 0;
+        bool encoded = reg && encodeBMSCommand(*reg, golden.arg1, golden.arg2, data) != BMS_ENCODE_INVALID;
+        if (!encoded || reg->address != golden.address || data != golden.data) {
+            if (result.mismatches++ == 0) {
+                result.firstMismatch = index;
+            }
+        }
+    }
+
+    // Identity registers refuse 0x0000, and names outside the table are not found
+    uint16_t data;
+    if (encodeBMSCommand(getBMSRegister(BMS_SERIAL_NUMBER_MSB), "0", nullptr, data) != BMS_ENCODE_INVALID ||
+        findBMSRegister("VCELL_OV") != nullptr || findBMSRegister("") != nullptr) {
+        result.mismatches++;
+    }
+
+    senseResistor = savedSenseResistor;
+    Imax = savedImax;
+    result.passed = (result.mismatches == 0);
+    return result;
+}
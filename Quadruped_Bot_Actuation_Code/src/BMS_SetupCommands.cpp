@@ -12,79 +12,37 @@
 
 #include "Arduino.h"
 #include "BMS_CoreCommands.h"
+#include "BMS_Registers.h" // Register descriptor table
+#include "BMS_NVM.h" // NVM commit budget
 
 
 
 
-// Function to send configuration commands to the BMS currently a list format to show each register.
+// Function to send configuration commands to the BMS. Registers, defaults and max values are in BMS_Registers.cpp.
 void sendBMSConfigCommand(const char* command, const char* valueStr) {
-    uint8_t registerAddress;
-    uint16_t defaultData = 0;
-    uint16_t maxData = 0b1111111111111111; // Default max, will be set per register
-
-    // Map commands to register addresses, default values, and max values (all in binary)
-    if (strcmp(command, "CFG2_ENABLES") == 0) {
-        registerAddress = 0x04;
-        defaultData = 0b0001100111111111; // 0x19FF
-        maxData    = 0b0011111111111111; // 0x3FFF
-    } else if (strcmp(command, "TO_PRDV_BAL_MSK") == 0) {
-        registerAddress = 0x13;
-        defaultData = 0b0111111111111111; // 0x7FFF
-        maxData    = 0b0111111111111111; // 0x7FFF
-    } else if (strcmp(command, "TO_FUSE_RST_MSK") == 0) {
-        registerAddress = 0x14;
-        defaultData = 0b0000000001111111; // 0x007F
-        maxData    = 0b0000000001111111; // 0x007F
-    } else if (strcmp(command, "TO_FAULTN_MSK") == 0) {
-        registerAddress = 0x15;
-        defaultData = 0b0000111111111111; // 0x0FFF
-        maxData    = 0b0000111111111111; // 0x0FFF
-    } else if (strcmp(command, "CURR_MSK") == 0) {
-        registerAddress = 0x16;
-        defaultData = 0b0000111111111111; // 0x0FFF
-        maxData    = 0b0000111111111111; // 0x0FFF
-    } else if (strcmp(command, "DIAG_OV_OT_UT") == 0) {
-        registerAddress = 0x2A;
-        defaultData = 0b0000000000000000; // 0x0000
-        maxData    = 0b1111111111111111; // 0xFFFF
-    } else if (strcmp(command, "DIAG_UV") == 0) {
-        registerAddress = 0x2B;
-        defaultData = 0b0000000000000000; // 0x0000
-        maxData    = 0b1111111111111111; // 0xFFFF
-    } else if (strcmp(command, "DIAG_CURR") == 0) {
-        registerAddress = 0x2F;
-        defaultData = 0b0000000000000000; // 0x0000
-        maxData    = 0b1111111111111111; // 0xFFFF
-    } else {
+    const BmsRegisterDescriptor* reg = findBMSRegister(command);
+    if (!reg || reg->group != BMS_GROUP_CONFIG) {
         Serial.println("Unknown Config command.");
         return;
     }
 
     uint16_t data = 0;
-    if (strcmp(valueStr, "default") == 0) {
-        data = defaultData;
-    } else if (strncmp(valueStr, "0b", 2) == 0) {
-        data = (uint16_t)strtol(valueStr + 2, nullptr, 2);
-        if (data > maxData) {
-            Serial.print("Warning: Value ");
-            Serial.print(valueStr);
-            Serial.print(" exceeds max allowed for ");
-            Serial.print(command);
-            Serial.print(". Capping to 0b");
-            for (int i = 15; i >= 0; --i) Serial.print((maxData >> i) & 1);
-            Serial.println();
-            data = maxData;
-        }
-    } else {
+    BmsEncodeStatus status = encodeBMSCommand(*reg, valueStr, nullptr, data);
+    if (status == BMS_ENCODE_INVALID) {
         Serial.println("Error: Value must be \"default\" or a binary string like \"0b101010\".");
         return;
     }
-
-    //Checks if conversion is active and if so turns it off.
-    if (bmsConversionActive == 1) {
-        setBMSConversionState("CONVERSION_OFF");
+    if (status == BMS_ENCODE_CAPPED) {
+        Serial.print("Warning: Value ");
+        Serial.print(valueStr);
+        Serial.print(" exceeds max allowed for ");
+        Serial.print(command);
+        Serial.print(". Capping to 0b");
+        for (int i = 15; i >= 0; --i) Serial.print((data >> i) & 1);
+        Serial.println();
     }
-    writeBMSData(0x49, registerAddress, data);
+
+    writeBMSRegister(*reg, data);
 
     Serial.print("Config Command sent: ");
     Serial.print(command);
@@ -98,25 +56,23 @@ void sendBMSConfigCommand(const char* command, const char* valueStr) {
 
 
 void RWBMSNVM(const char* command) {
-    uint8_t registerAddress;
-    uint16_t data;
-
-    if (strcmp(command, "NVM_2_DL") == 0) {
-        registerAddress = 0x20; // THIS COMMAND CAN ONLY BE ISSUED 32 TIMES!!! This is the command to commit the changes to the NVM FROM I2C
-        data = 0xAAAA;          // NEVER PUT THIS IN THE MAIN LOOP, SETUP ONLY!
-    } else if (strcmp(command, "NVM_2_UL") == 0) {
-        registerAddress = 0x20; // This is the command to commit the DATA from the NVM TO I2C, this should be called on startup.
-        data = 0x5555;          // This is the command as seen in the datasheets.
-    } else {
+    // NVM_2_DL commits the I2C registers to the NVM. THIS COMMAND CAN ONLY BE ISSUED 32 TIMES!!!
+    // NEVER PUT THIS IN THE MAIN LOOP, SETUP ONLY!
+    // NVM_2_UL loads the NVM into the I2C registers, this should be called on startup.
+    const BmsRegisterDescriptor* reg = findBMSRegister(command);
+    if (!reg || reg->group != BMS_GROUP_NVM) {
         Serial.println("Unknown NVM command.");
         return;
     }
 
-    //Checks if conversion is active and if so turns it off.
-    if (bmsConversionActive == 1) {
-        setBMSConversionState("CONVERSION_OFF");
+    // Every commit is counted against the device's budget of 32 before it is issued
+    if (reg->id == BMS_NVM_2_DL && !takeBMSNvmCommit()) {
+        return;
     }
-    writeBMSData(0x49, registerAddress, data);
+
+    uint16_t data = 0;
+    encodeBMSCommand(*reg, nullptr, nullptr, data);
+    writeBMSRegister(*reg, data);
 
     Serial.print("NVM Command sent: ");
     Serial.print(command);
@@ -125,10 +81,8 @@ void RWBMSNVM(const char* command) {
     delay(100); // Add a delay to ensure the command is processed
 }
 
-//Function to assign identity and and other unique information to the bms chip. these have no bearing on performance so are ideal to test commands.
 //Function to assign identity and and other unique information to the bms chip. these have no bearing on performance so are ideal to test commands.
 void sendBMSIdentityCommand(const char* command, uint16_t data) {
-    uint8_t registerAddress;
     // Statement to prevent the identity value from being 0x0000. this could be used to check NVM is been used.
     if (data == 0x0000) {
         Serial.print("Error: Identity value for ");
@@ -137,33 +91,14 @@ void sendBMSIdentityCommand(const char* command, uint16_t data) {
         return;
     }
 
-    if (strcmp(command, "MANUFACTURE_NAME_MSB") == 0) {
-        registerAddress = 0x17;
-    } else if (strcmp(command, "MANUFACTURE_NAME_LSB") == 0) {
-        registerAddress = 0x18;
-    } else if (strcmp(command, "MANUFACTURING_DATE") == 0) {
-        registerAddress = 0x19;
-    } else if (strcmp(command, "FIRST_USAGE_DATE") == 0) {
-        registerAddress = 0x1A;
-    } else if (strcmp(command, "SERIAL_NUMBER_MSB") == 0) {
-        registerAddress = 0x1B;
-    } else if (strcmp(command, "SERIAL_NUMBER_LSB") == 0) {
-        registerAddress = 0x1C;
-    } else if (strcmp(command, "DEVICE_NAME_MSB") == 0) {
-        registerAddress = 0x1D;
-    } else if (strcmp(command, "DEVICE_NAME_LSB") == 0) {
-        registerAddress = 0x1E;
-    } else {
+    const BmsRegisterDescriptor* reg = findBMSRegister(command);
+    if (!reg || reg->group != BMS_GROUP_IDENTITY) {
         Serial.println("Unknown identity command.");
         return;
     }
 
-    //Checks if conversion is active and if so turns it off.
-    // This is to ensure that the BMS is not in conversion mode while writing identity data.
-    if (bmsConversionActive == 1) {
-        setBMSConversionState("CONVERSION_OFF");
-    }
-    writeBMSData(0x49, registerAddress, data);
+    // Conversions are turned off so the BMS is not in conversion mode while writing identity data.
+    writeBMSRegister(*reg, data);
 
     Serial.print("Identity Command sent: ");
     Serial.print(command);
@@ -173,46 +108,16 @@ void sendBMSIdentityCommand(const char* command, uint16_t data) {
 
 
 void sendBMSRealTimeCommand(const char* command) {
-    uint8_t registerAddress;
-    uint16_t data;
-
-    // Map commands to register addresses and data values
-    if (strcmp(command, "BAL_ENABLE") == 0) {
-        registerAddress = 0x01; // Register address to interface with balancing fets
-        data = 0x001F;          // set balancing on
-    } else if (strcmp(command, "BAL_DISABLE") == 0) {
-        registerAddress = 0x01; // Register address to interface with balancing fets
-        data = 0x0000;          // Set balancing off
-    } else if (strcmp(command, "GO2SHIP") == 0) {
-        registerAddress = 0x21; // Sends the device to ship mode. this is a low power mode.
-        data = 0x2000;          // Sends the 10 to 13th-14th bit note as with all write commands sets the read only registers zero, erasing the information.
-    } else if (strcmp(command, "GO2STBY") == 0) {
-        registerAddress = 0x22; // Sends the chip to standby mode. this is a low power mode.
-        data = 0x2000;          // sets the 10 to 13th-14th bit note as with all write commands sets the read only registers zero, erasing the information.
-    } else if (strcmp(command, "FUSE_TRIG_DISARM") == 0) {
-        registerAddress = 0x23; // turns off the fuse
-        data = 0x1000;          // 
-    } else if (strcmp(command, "FUSE_TRIG_ARM") == 0) {
-        registerAddress = 0x23; // turns on the fuse
-        data = 0x2000;          // set all high as is opposite the default
-    } else if (strcmp(command, "FUSE_TRIG_FIRE_INTERRUPT") == 0) {
-        registerAddress = 0x24; // Stops the fuse from firing
-        data = 0x1000;          // set to 1 on the 13th bit to stop the fuse from firing.
-    } else if (strcmp(command, "FUSE_TRIG_FIRE") == 0) {
-        registerAddress = 0x24; // A read/write bit that can be actuated by the BMS or the MCU.
-        data = 0x2000;          // this will fire on command.
-    }  else {
+    // Balancing, low power modes and the fuse, each a fixed value from the register table
+    const BmsRegisterDescriptor* reg = findBMSRegister(command);
+    if (!reg || reg->group != BMS_GROUP_REALTIME) {
         Serial.println("Unknown Real Time command.");
         return;
     }
 
-    //Checks if conversion is active and if so turns it off.
-    // This is to ensure that the BMS is not in conversion mode while writing configuration data.
-    if (bmsConversionActive == 1) {
-        setBMSConversionState("CONVERSION_OFF");
-        
-    }
-    writeBMSData(0x49, registerAddress, data);
+    uint16_t data = 0;
+    encodeBMSCommand(*reg, nullptr, nullptr, data);
+    writeBMSRegister(*reg, data);
 
     Serial.print("BMS Command sent: ");
     Serial.print(command);
@@ -0,0 +1,161 @@
+// BMS_Snapshot.cpp
+// ----------------
+// Implementation of RDY-driven acquisition of the L9961 measurements.
+// The RDY interrupt queues the read of the first register and the completion callback of each read
+// queues the next, so the block takes one slot of the Wire1 queue and runs entirely from interrupts.
+// Completed blocks are published into a double buffer, in the same way as the encoder snapshots.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "PinAssignments.h"
+#include "BMS_Snapshot.h"
+
+static uint8_t bmsAddress = 0x49;
+
+static BmsSnapshot snapshots[2]; // double buffer, one published and one being filled
+static volatile uint8_t publishedIndex = 0;
+static volatile uint32_t publishedSequence = 0;
+
+static volatile bool acquiring = false;
+static volatile bool overlapped = false; // another RDY edge came while the block was being read
+static uint8_t fillIndex = 1;
+static uint8_t readIndex = 0; // register of the block being read
+static uint32_t sequenceCounter = 0;
+
+static volatile BmsSnapshotStats stats;
+
+static void onRegisterRead(const I2C_Job& job);
+
+// Registers read by each job, the whole block when the BMS auto-increments
+#if L9961_AUTO_INCREMENT
+#define SNAPSHOT_READ_WORDS BMS_MEASUREMENT_COUNT
+#else
+#define SNAPSHOT_READ_WORDS 1
+#endif
+
+// Queues the read of the next registers of the block. Returns false if the queue is full.
+static bool queueRegister() {
+    uint8_t registerAddress = BMS_MEASUREMENT_FIRST_REGISTER + readIndex;
+    return I2C_Enqueue(I2C_BUS_WIRE1, bmsAddress, &registerAddress, 1, 2 * SNAPSHOT_READ_WORDS, onRegisterRead,
+                       nullptr, I2C_FLAG_STOP_BEFORE_READ) != 0;
+}
+
+static void finishBlock(uint32_t landTime) {
+    BmsSnapshot& snapshot = snapshots[fillIndex];
+    snapshot.readMicros = landTime - snapshot.readyTime;
+    snapshot.inWindow = !overlapped && snapshot.readMicros <= validWindow;
+    decodeBMSMeasurements(snapshot.measurements);
+    snapshot.sequence = ++sequenceCounter;
+
+    // Publish the filled buffer, readers check the sequence to detect a swap during their copy
+    publishedIndex = fillIndex;
+    publishedSequence = snapshot.sequence;
+
+    stats.published++;
+    if (!snapshot.inWindow) {
+        stats.missedWindow++;
+    }
+    stats.lastReadMicros = snapshot.readMicros;
+    if (snapshot.readMicros > stats.maxReadMicros) {
+        stats.maxReadMicros = snapshot.readMicros;
+    }
+    acquiring = false;
+}
+
+// Completion callback of each register read, runs in the I2C interrupt
+static void onRegisterRead(const I2C_Job& job) {
+    uint32_t landTime = micros();
+    if (job.state != I2C_JOB_DONE) {
+        stats.failed++;
+        acquiring = false;
+        return;
+    }
+    uint16_t* raw = snapshots[fillIndex].measurements.raw;
+    for (uint8_t word = 0; word < SNAPSHOT_READ_WORDS; word++) {
+        raw[readIndex++] = (job.rxData[2 * word] << 8) | job.rxData[2 * word + 1]; // MSB first
+    }
+
+    if (readIndex < BMS_MEASUREMENT_COUNT) {
+        if (!queueRegister()) {
+            stats.failed++;
+            acquiring = false;
+        }
+        return;
+    }
+    finishBlock(landTime);
+}
+
+// RDY rising edge
+static void onSnapshotReady() {
+    onBMSReadyRise();
+    if (acquiring) {
+        overlapped = true; // the block being read now spans two conversions
+        return;
+    }
+
+    // Fill the buffer readers are not looking at
+    fillIndex = publishedIndex ^ 1;
+    readIndex = 0;
+    overlapped = false;
+    snapshots[fillIndex].readyTime = bmsDataTimestamp;
+    acquiring = true;
+    if (!queueRegister()) {
+        stats.failed++;
+        acquiring = false;
+    }
+}
+
+
+void bmsSnapshotBegin(uint8_t chipAddress) {
+    bmsAddress = chipAddress;
+    // Pin interrupts run at the default priority of 128, the same as the bus interrupts, so the RDY
+    // edge can preempt the main loop queuing on Wire1 but never the queue's own interrupt
+    attachInterrupt(digitalPinToInterrupt(RDY), onSnapshotReady, RISING);
+}
+
+bool getBMSSnapshot(BmsSnapshot& snapshot) {
+    // A block can only overwrite the buffer being copied after it has been republished,
+    // so a second attempt from the newly published buffer has a full conversion cycle to finish.
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        uint32_t sequence = publishedSequence;
+        if (sequence == 0) {
+            return false; // nothing published yet
+        }
+        snapshot = snapshots[publishedIndex];
+        if (publishedSequence == sequence && snapshot.sequence == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t getBMSSnapshotSequence() {
+    return publishedSequence;
+}
+
+uint32_t getBMSSnapshotAge() {
+    return micros() - snapshots[publishedIndex].readyTime;
+}
+
+BmsSnapshotStats getBMSSnapshotStats() {
+    // The counters are written from interrupts, keep them out while copying
+    __disable_irq();
+    BmsSnapshotStats copy = {stats.published, stats.missedWindow, stats.failed, stats.lastReadMicros, stats.maxReadMicros};
+    __enable_irq();
+    return copy;
+}
+
+void resetBMSSnapshotStats() {
+    __disable_irq();
+    stats.published = 0;
+    stats.missedWindow = 0;
+    stats.failed = 0;
+    stats.lastReadMicros = 0;
+    stats.maxReadMicros = 0;
+    __enable_irq();
+}
@@ -101,47 +101,108 @@ bool isBMSDataValid() {
 
 
 // Single Read Function for L9961
+I2C_Status readBMSRegister(uint8_t chipAddress, uint8_t registerAddress, uint16_t& data) {
+    // The register address, a STOP, then a read of two bytes, retried on bus errors and timeouts.
+    // The STOP is kept from the original Wire sequence, the bus free time before the read start covers tbuf.
+    uint8_t bytes[2];
+    I2C_Status status = I2C_Transfer(I2C_BUS_WIRE1, chipAddress, &registerAddress, 1, bytes, 2, I2C_FLAG_STOP_BEFORE_READ);
+    if (status == I2C_OK) {
+        data = (bytes[0] << 8) | bytes[1]; // Combine the MSB and LSB into a 16-bit value
+    }
+    return status;
+}
+
 uint16_t readBMSData(uint8_t chipAddress, uint8_t registerAddress) {
     uint16_t data = 0;
+    readBMSRegister(chipAddress, registerAddress, data);
+    return data;
+}
+
+
+// Queued read of one register, returns without waiting for the bus
+uint32_t readBMSDataAsync(uint8_t chipAddress, uint8_t registerAddress, I2C_Callback callback, void* context) {
+    return I2C_EnqueueWaiting(I2C_BUS_WIRE1, chipAddress, &registerAddress, 1, 2, callback, context, I2C_FLAG_STOP_BEFORE_READ);
+}
+
+
+uint16_t getBMSDataFromJob(const I2C_Job& job) {
+    return (job.rxData[0] << 8) | job.rxData[1]; // MSB first
+}
 
-    // Step 1: Send the slave address with the write bit and the register address
-    Wire1.beginTransmission(chipAddress);
-    Wire1.write(registerAddress);
-    Wire1.endTransmission(true); // Send a repeated start condition
-    delayMicroseconds(3); // Small delay to allow the device to process the request (tbuf)
-    // Step 2: Send the slave address with the read bit
-    Wire1.requestFrom(chipAddress, (uint8_t)2, true); // Request 2 bytes from the slave
-
-    // Step 3: Read the two bytes of data
-    if (Wire1.available() >= 2) {
-        uint8_t highByte = Wire1.read(); // Read the first byte (MSB)
-        uint8_t lowByte = Wire1.read();  // Read the second byte (LSB)
-        data = (highByte << 8) | lowByte; // Combine the two bytes into a 16-bit value
+
+// State of one pipelined block read, on the caller's stack and shared by its jobs through the context
+struct BlockRead {
+    uint16_t* words;
+    uint8_t firstRegister;
+    volatile I2C_Status status; // first failure, set from the I2C interrupt
+};
+
+// Completion callback of each register of a pipelined block read. The register the job wrote gives
+// the word it fills, so every job of a read can share the one context.
+static void onBlockWordRead(const I2C_Job& job) {
+    BlockRead* block = (BlockRead*)job.context;
+    uint16_t* word = &block->words[job.txData[0] - block->firstRegister];
+    if (job.state == I2C_JOB_DONE) {
+        *word = getBMSDataFromJob(job);
+    } else {
+        *word = 0;
+        if (block->status == I2C_OK) {
+            block->status = job.status;
+        }
+    }
+}
+
+I2C_Status readBMSBlock(uint8_t chipAddress, uint8_t firstRegister, uint16_t* words, uint8_t count) {
+    if (count == 0) {
+        return I2C_OK;
     }
 
-    return data;
+#if L9961_AUTO_INCREMENT
+    // One register address, then every word of the range in a single read, in chunks the job can hold
+    I2C_Status result = I2C_OK;
+    for (uint8_t offset = 0; offset < count; offset += BMS_BLOCK_MAX_WORDS) {
+        uint8_t chunkWords = (count - offset < BMS_BLOCK_MAX_WORDS) ? count - offset : BMS_BLOCK_MAX_WORDS;
+        uint8_t registerAddress = firstRegister + offset;
+        uint8_t bytes[I2C_JOB_MAX_DATA];
+        I2C_Status status = I2C_Transfer(I2C_BUS_WIRE1, chipAddress, &registerAddress, 1, bytes, chunkWords * 2,
+                                         I2C_FLAG_STOP_BEFORE_READ);
+        for (uint8_t index = 0; index < chunkWords; index++) {
+            words[offset + index] = (status == I2C_OK) ? ((bytes[2 * index] << 8) | bytes[2 * index + 1]) : 0;
+        }
+        if (status != I2C_OK && result == I2C_OK) {
+            result = status;
+        }
+    }
+    return result;
+#else
+    // Every register queued at once, the interrupt starts each read as soon as the last one ends.
+    // Jobs on a bus run in order, so once the last one is done they all are.
+    // The state must outlive the jobs, which it does as the last one is waited on before returning.
+    BlockRead block = {words, firstRegister, I2C_OK};
+    uint32_t lastTicket = 0;
+    for (uint8_t index = 0; index < count; index++) {
+        uint8_t registerAddress = firstRegister + index;
+        lastTicket = I2C_EnqueueWaiting(I2C_BUS_WIRE1, chipAddress, &registerAddress, 1, 2, onBlockWordRead,
+                                        &block, I2C_FLAG_STOP_BEFORE_READ);
+    }
+    I2C_Wait(I2C_BUS_WIRE1, lastTicket);
+    return block.status;
+#endif
 }
 
 
 // Function to write data to the BMS module
 void writeBMSData(uint8_t chipAddress, uint8_t registerAddress, uint16_t data) {
-    // Step 1: Start communication with the slave device
-    Wire1.beginTransmission(chipAddress);
-
-    // Step 2: Send the register address
-    Wire1.write(registerAddress);
-
-    // Step 3: Send the two data bytes (MSB first, then LSB)
+    // The register address, then the two data bytes (MSB first, then LSB)
     uint8_t highByte = (data >> 8) & 0xFF; // Extract the most significant byte
     uint8_t lowByte = data & 0xFF;        // Extract the least significant byte
-    Wire1.write(highByte);                // Send the MSB
-    Wire1.write(lowByte);                 // Send the LSB
+    const uint8_t txData[] = {registerAddress, highByte, lowByte};
 
-    // Step 4: End the transmission (send a stop condition)
-    if (Wire1.endTransmission(true) != 0) { // Check for errors
-        Serial.println("Error: Failed to write data to BMS.");
-    } else {
-        Serial.println("Write successful.");
+    // Wait for the write to complete so errors can be reported, success is silent
+    I2C_Status status = I2C_Transfer(I2C_BUS_WIRE1, chipAddress, txData, sizeof(txData), nullptr, 0);
+    if (status != I2C_OK) { // Check for errors
+        Serial.print("Error: Failed to write data to BMS, ");
+        Serial.println(I2C_StatusName(status));
     }
 }
 
@@ -0,0 +1,77 @@
+// I2C_ClockProfiles.cpp
+// ---------------------
+// Implementation of the bus clock profiles and the dual-bus overlap benchmark.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "I2C_ClockProfiles.h"
+#include "I2C_MUX.h" // Channel selection for the driver reads
+
+static uint32_t clockProfiles[I2C_BUS_COUNT] = {I2C_CLOCK_STANDARD, I2C_CLOCK_STANDARD}; // Wire and Wire1 default to 100kHz
+
+
+bool I2C_SetClockProfile(uint8_t bus, uint32_t clockHz) {
+    if (bus >= I2C_BUS_COUNT) {
+        Serial.println("Error: Invalid I2C bus.");
+        return false;
+    }
+    if (clockHz != I2C_CLOCK_STANDARD && clockHz != I2C_CLOCK_FAST && clockHz != I2C_CLOCK_FAST_PLUS) {
+        Serial.println("Error: I2C clock must be 100000, 400000 or 1000000 Hz.");
+        return false;
+    }
+    uint32_t maxClock = (bus == I2C_BUS_WIRE) ? I2C_WIRE_MAX_CLOCK : I2C_WIRE1_MAX_CLOCK;
+    if (clockHz > maxClock) {
+        Serial.print("Error: Devices on this bus are limited to ");
+        Serial.print(maxClock);
+        Serial.println(" Hz.");
+        return false;
+    }
+
+    I2C_SetClock(bus, clockHz);
+    clockProfiles[bus] = clockHz;
+    return true;
+}
+
+uint32_t I2C_GetClockProfile(uint8_t bus) {
+    return (bus < I2C_BUS_COUNT) ? clockProfiles[bus] : 0;
+}
+
+// Queues a register read, waiting for a free slot if the ring is full
+static uint32_t queueRead(uint8_t bus, uint8_t address, uint8_t registerAddress, uint8_t length, uint8_t flags) {
+    return I2C_EnqueueWaiting(bus, address, &registerAddress, 1, length, nullptr, nullptr, flags);
+}
+
+I2C_OverlapBenchmark benchmarkBusOverlap(uint16_t iterations, uint8_t bmsAddress, uint8_t driverAddress) {
+    I2C_OverlapBenchmark result = {iterations, 0, 0};
+    const uint8_t bmsRegister = 0x21;   // first measurement register of the L9961
+    const uint8_t driverRegister = 0x00; // input register of the LP3943
+
+    I2C_SelectChannelMask(I2C_MUX_ADDRESS, 0x01); // a driver to read from, without the Serial output
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    I2C_WaitIdle(I2C_BUS_WIRE1);
+
+    // One bus at a time, as the blocking Wire calls did
+    uint32_t start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        I2C_Wait(I2C_BUS_WIRE1, queueRead(I2C_BUS_WIRE1, bmsAddress, bmsRegister, 2, I2C_FLAG_STOP_BEFORE_READ));
+        I2C_Wait(I2C_BUS_WIRE, queueRead(I2C_BUS_WIRE, driverAddress, driverRegister, 1, 0));
+    }
+    result.serialMicros = micros() - start;
+
+    // Both buses queued at once
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        uint32_t bmsTicket = queueRead(I2C_BUS_WIRE1, bmsAddress, bmsRegister, 2, I2C_FLAG_STOP_BEFORE_READ);
+        uint32_t driverTicket = queueRead(I2C_BUS_WIRE, driverAddress, driverRegister, 1, 0);
+        I2C_Wait(I2C_BUS_WIRE1, bmsTicket);
+        I2C_Wait(I2C_BUS_WIRE, driverTicket);
+    }
+    result.concurrentMicros = micros() - start;
+
+    return result;
+}
@@ -0,0 +1,114 @@
+// I2C_DeviceStats.cpp
+// -------------------
+// Implementation of the per-device I2C statistics.
+// Entries are claimed the first time a device is seen and never moved, so a lookup is a short linear
+// search over the claimed entries.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "I2C_DeviceStats.h"
+
+struct DeviceRecord {
+    I2C_DeviceStats stats;
+    uint64_t latencySum;
+};
+
+static DeviceRecord devices[I2C_DEVICE_STATS_MAX];
+static volatile uint8_t deviceCount = 0;
+static volatile uint32_t droppedRecords = 0;
+
+
+static DeviceRecord* findDevice(uint8_t bus, uint8_t address, uint8_t muxMask) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        const I2C_DeviceStats& stats = devices[i].stats;
+        if (stats.bus == bus && stats.address == address && stats.muxMask == muxMask) {
+            return &devices[i];
+        }
+    }
+    if (deviceCount >= I2C_DEVICE_STATS_MAX) {
+        return nullptr;
+    }
+
+    DeviceRecord& record = devices[deviceCount];
+    memset(&record, 0, sizeof(record));
+    record.stats.bus = bus;
+    record.stats.address = address;
+    record.stats.muxMask = muxMask;
+    deviceCount++;
+    return &record;
+}
+
+static uint8_t latencyBucket(uint32_t latency) {
+    uint8_t bucket = 0;
+    while (bucket < I2C_LATENCY_BUCKETS - 1 && latency >= ((uint32_t)I2C_LATENCY_BUCKET_BASE_US << bucket)) {
+        bucket++;
+    }
+    return bucket;
+}
+
+void I2C_RecordTransaction(uint8_t bus, uint8_t address, uint8_t muxMask, I2C_Status status, uint32_t latency) {
+    DeviceRecord* record = findDevice(bus, address, muxMask);
+    if (record == nullptr) {
+        droppedRecords++; // table full
+        return;
+    }
+    I2C_DeviceStats& stats = record->stats;
+
+    if (stats.transactions == 0 || latency < stats.minLatency) {
+        stats.minLatency = latency;
+    }
+    if (latency > stats.maxLatency) {
+        stats.maxLatency = latency;
+    }
+    stats.transactions++;
+    record->latencySum += latency;
+    stats.histogram[latencyBucket(latency)]++;
+
+    if (status != I2C_OK) {
+        stats.errors++;
+    }
+    if (status == I2C_ERROR_TIMEOUT) {
+        stats.timeouts++;
+    }
+}
+
+uint8_t I2C_GetDeviceCount() {
+    return deviceCount;
+}
+
+uint32_t I2C_GetDroppedDeviceRecords() {
+    return droppedRecords;
+}
+
+bool I2C_GetDeviceStats(uint8_t index, I2C_DeviceStats& stats) {
+    if (index >= deviceCount) {
+        return false;
+    }
+    // Both queue interrupts write the table, keep them out while copying
+    __disable_irq();
+    stats = devices[index].stats;
+    uint64_t latencySum = devices[index].latencySum;
+    __enable_irq();
+
+    stats.meanLatency = (stats.transactions > 0) ? (uint32_t)(latencySum / stats.transactions) : 0;
+    return true;
+}
+
+void I2C_ResetDeviceStats() {
+    __disable_irq();
+    deviceCount = 0;
+    droppedRecords = 0;
+    __enable_irq();
+}
+
+uint32_t I2C_GetLatencyBucketLimit(uint8_t bucket) {
+    if (bucket >= I2C_LATENCY_BUCKETS - 1) {
+        return 0;
+    }
+    return (uint32_t)I2C_LATENCY_BUCKET_BASE_US << bucket;
+}
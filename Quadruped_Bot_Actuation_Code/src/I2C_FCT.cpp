@@ -2,6 +2,8 @@
 // -----------
 // Implementation of I2C functions for reading and writing data to I2C devices.
 // Provides overloaded functions for single and dual I2C channels, supporting register and data byte access.
+// The functions are thin wrappers over the transaction queue in I2C_Queue.h: writes are queued and
+// return straight away, reads wait for their own job to complete.
 //
 // Author: Greg Moxon
 // Organisation: Moxon Electronics
@@ -11,21 +13,49 @@
 
 #include "PinAssignments.h"
 #include "I2C_FCT.h"
+#include "I2C_Queue.h" // All traffic goes through the background transaction queue
+
+// Queues a write, waiting for a free slot if the ring is full.
+// Failures are not reported to the caller but are counted in the device statistics.
+static void postWrite(uint8_t bus, uint8_t chipAddress, const uint8_t* data, uint8_t length) {
+  I2C_EnqueueWaiting(bus, chipAddress, data, length, 0);
+}
+
+// Reads one byte with the bounded, retried transfer. data is left alone unless the read succeeded.
+static I2C_Status readByte(uint8_t bus, uint8_t chipAddress, const uint8_t* registerAddress, uint8_t length, uint8_t& data) {
+  uint8_t received = 0;
+  I2C_Status status = I2C_Transfer(bus, chipAddress, registerAddress, length, &received, 1);
+  if (status == I2C_OK) {
+    data = received;
+  }
+  return status;
+}
+
+// Reads one byte, 0 if the device did not answer
+static uint8_t readByteOrZero(uint8_t bus, uint8_t chipAddress, const uint8_t* registerAddress, uint8_t length) {
+  uint8_t data = 0;
+  readByte(bus, chipAddress, registerAddress, length, data);
+  return data;
+}
+
+I2C_Status I2C_ReadByte(uint8_t bus, uint8_t chipAddress, uint8_t& data) {
+  return readByte(bus, chipAddress, nullptr, 0, data);
+}
+
+I2C_Status I2C_ReadRegister(uint8_t bus, uint8_t chipAddress, uint8_t registerAddress, uint8_t& data) {
+  return readByte(bus, chipAddress, &registerAddress, 1, data); // register address, repeated start, then read
+}
 
 // Function to write to a specific I2C address on the defualt i2c channel.
 // Overloaded function for devices with only chip address and data byte
 void I2C_WR(uint8_t chipAddress, uint8_t dataByte) {
-  Wire.beginTransmission(chipAddress);
-  Wire.write(dataByte);
-  Wire.endTransmission();
+  postWrite(I2C_BUS_WIRE, chipAddress, &dataByte, 1);
 }
 
 // Overloaded function for devices with chip address, register address, and data byte
 void I2C_WR(uint8_t chipAddress, uint8_t registerAddress, uint8_t dataByte) {
-  Wire.beginTransmission(chipAddress);
-  Wire.write(registerAddress); // Write the register address first
-  Wire.write(dataByte);        // Then write the data byte
-  Wire.endTransmission();
+  const uint8_t data[] = {registerAddress, dataByte}; // register address first, then the data byte
+  postWrite(I2C_BUS_WIRE, chipAddress, data, sizeof(data));
 }
 
 
@@ -35,30 +65,13 @@ void I2C_WR(uint8_t chipAddress, uint8_t registerAddress, uint8_t dataByte) {
 // This only takes one address and returns one byte of data
 // Overloaded function for devices with only chip address
 uint8_t I2C_RD(uint8_t chipAddress) {
-  Wire.beginTransmission(chipAddress); // Start communication with the device
-  Wire.endTransmission(false);         // Send a repeated start condition
-  Wire.requestFrom(chipAddress, 1);    // Request 1 byte from the device
-
-  while (!Wire.available()) {
-    // Wait until data is available
-  }
-
-  return Wire.read(); // Read and return the received byte
+  return readByteOrZero(I2C_BUS_WIRE, chipAddress, nullptr, 0);
 }
 
 // Overloaded function for devices with chip address and register address
 // This function reads a byte from a specific register of an I2C device
 uint8_t I2C_RD(uint8_t chipAddress, uint8_t registerAddress) {
-  Wire.beginTransmission(chipAddress); // Start communication with the device
-  Wire.write(registerAddress);         // Specify the register to read from
-  Wire.endTransmission(false);         // Send a repeated start condition
-  Wire.requestFrom(chipAddress, 1);    // Request 1 byte from the device
-
-  while (!Wire.available()) {
-    // Wait until data is available
-  }
-
-  return Wire.read(); // Read and return the received byte
+  return readByteOrZero(I2C_BUS_WIRE, chipAddress, &registerAddress, 1); // register address, repeated start, then read
 }
 
 
@@ -68,17 +81,13 @@ uint8_t I2C_RD(uint8_t chipAddress, uint8_t registerAddress) {
 // Function to write to a specific I2C address on the second i2c channel.
 // Overloaded function for devices with only chip address and data byte
 void I2C_WR1(uint8_t chipAddress, uint8_t dataByte) {
-  Wire1.beginTransmission(chipAddress);
-  Wire1.write(dataByte);
-  Wire1.endTransmission();
+  postWrite(I2C_BUS_WIRE1, chipAddress, &dataByte, 1);
 }
 
 // Overloaded function for devices with chip address, register address, and data byte
 void I2C_WR1(uint8_t  chipAddress, uint8_t registerAddress, uint8_t dataByte) {
-  Wire1.beginTransmission(chipAddress);
-  Wire1.write(registerAddress); // Write the register address first
-  Wire1.write(dataByte);        // Then write the data byte
-  Wire1.endTransmission();
+  const uint8_t data[] = {registerAddress, dataByte}; // register address first, then the data byte
+  postWrite(I2C_BUS_WIRE1, chipAddress, data, sizeof(data));
 }
 
 
@@ -88,28 +97,11 @@ void I2C_WR1(uint8_t  chipAddress, uint8_t registerAddress, uint8_t dataByte) {
 // This only takes one address and returns one byte of data
 // Overloaded function for devices with only chip address
 uint8_t I2C_RD1(uint8_t chipAddress) {
-  Wire1.beginTransmission(chipAddress); // Start communication with the device
-  Wire1.endTransmission(false);         // Send a repeated start condition
-  Wire1.requestFrom(chipAddress, 1);    // Request 1 byte from the device
-
-  while (!Wire1.available()) {
-    // Wait until data is available
-  }
-
-  return Wire1.read(); // Read and return the received byte
+  return readByteOrZero(I2C_BUS_WIRE1, chipAddress, nullptr, 0);
 }
 
 // Overloaded function for devices with chip address and register address
 // This function reads a byte from a specific register of an I2C device
 uint8_t I2C_RD1(uint8_t chipAddress, uint8_t registerAddress) {
-  Wire1.beginTransmission(chipAddress); // Start communication with the device
-  Wire1.write(registerAddress);         // Specify the register to read from
-  Wire1.endTransmission(false);         // Send a repeated start condition
-  Wire1.requestFrom(chipAddress, 1);    // Request 1 byte from the device
-
-  while (!Wire1.available()) {
-    // Wait until data is available
-  }
-
-  return Wire1.read(); // Read and return the received byte
+  return readByteOrZero(I2C_BUS_WIRE1, chipAddress, &registerAddress, 1); // register address, repeated start, then read
 }
\ No newline at end of file
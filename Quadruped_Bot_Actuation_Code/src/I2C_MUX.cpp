@@ -4,6 +4,9 @@
 // Includes functions to select a specific channel and disable all channels on the multiplexer.
 // Only one channel is specified to be active at a time, but it is possible to use all at once.
 //
+// Control bytes are queued with a completion callback, which marks the chip state unknown if the
+// write was not acknowledged.
+//
 // Author: Greg Moxon
 // Organisation: Moxon Electronics
 // Created: 2024-05-16
@@ -14,10 +17,56 @@
 
 #include "PinAssignments.h"
 #include "I2C_MUX.h"
-#include "I2C_FCT.h" // Include the I2C_FCTNS header file
+#include "I2C_Queue.h" // Include the background I2C transaction queue header file
+
+#if I2C_MUX_TRACE
+#define MUX_TRACE(message, muxAddress, mask) \
+  do { Serial.print("I2C Multiplexer 0x"); Serial.print(muxAddress, HEX); Serial.print(message); Serial.println(mask, BIN); } while (0)
+#else
+#define MUX_TRACE(message, muxAddress, mask) do {} while (0)
+#endif
+
+// State of one multiplexer
+struct MuxState {
+  uint8_t selected;         // channels callers last asked for
+  volatile uint8_t held;    // channels the chip holds, valid when known is set
+  volatile bool known;      // false until the first write, and after a failed one
+};
 
-// Global variable to store the currently active channel
-static int8_t currentChannel = -1; // -1 indicates no channel is currently selected
+static MuxState muxStates[I2C_MUX_MAX_COUNT];
+
+
+
+// Multiplexer state for an address, null for addresses outside the PCA9548A range
+static MuxState* findMux(uint8_t muxAddress) {
+  if (muxAddress < I2C_MUX_BASE_ADDRESS || muxAddress >= I2C_MUX_BASE_ADDRESS + I2C_MUX_MAX_COUNT) {
+    Serial.println("\nError: Invalid multiplexer address!");
+    return nullptr;
+  }
+  return &muxStates[muxAddress - I2C_MUX_BASE_ADDRESS];
+}
+
+// Completion callback of a control byte write, runs in the I2C interrupt
+static void onControlWritten(const I2C_Job& job) {
+  MuxState& mux = *(MuxState*)job.context;
+  if (job.state != I2C_JOB_DONE) {
+    mux.known = false;
+  }
+}
+
+// Writes a control byte unless the chip already holds it
+static void writeControl(uint8_t muxAddress, MuxState& mux, uint8_t controlByte) {
+  mux.selected = controlByte;
+  if (mux.known && mux.held == controlByte) {
+    MUX_TRACE(" already holds 0b", muxAddress, controlByte);
+    return;
+  }
+  // Counted as held from now on, the queue keeps later writes behind this one
+  mux.held = controlByte;
+  mux.known = true;
+  I2C_EnqueueWaiting(I2C_BUS_WIRE, muxAddress, &controlByte, 1, 0, onControlWritten, &mux);
+  MUX_TRACE(" set to 0b", muxAddress, controlByte);
+}
 
 
 
@@ -28,36 +77,53 @@ void I2C_SelectChannel(uint8_t muxAddress, uint8_t channel) {
     Serial.println("\nError: Invalid channel requested! Must be between 0 and 7.");
     return;
   }
-
-  // Check if the requested channel is already active
-  if (currentChannel == channel) {
-    Serial.print("\nI2C Multiplexer: Channel ");
-    Serial.print(channel);
-    Serial.println(" is already active. No action taken.");
-    return;
+  MuxState* mux = findMux(muxAddress);
+  if (mux != nullptr) {
+    writeControl(muxAddress, *mux, 1 << channel);
   }
+}
 
-  // Create the control byte with only the desired channel active
-  uint8_t controlByte = (1 << channel);
-
-  // Use the I2C_WR function from I2C_FCTNS to send the control byte
-  I2C_WR(muxAddress, controlByte);
+// Function to disable all channels on the PCA9548A I2C multiplexer
+void I2C_DisableAllChannels(uint8_t muxAddress) {
+  MuxState* mux = findMux(muxAddress);
+  if (mux != nullptr) {
+    writeControl(muxAddress, *mux, 0x00);
+  }
+}
 
-  // Update the currently active channel
-  currentChannel = channel;
+// Function to enable several channels on the PCA9548A I2C multiplexer at once
+void I2C_SelectChannelMask(uint8_t muxAddress, uint8_t channelMask) {
+  MuxState* mux = findMux(muxAddress);
+  if (mux != nullptr) {
+    writeControl(muxAddress, *mux, channelMask);
+  }
+}
 
-  Serial.print("\nI2C Multiplexer: Channel ");
-  Serial.print(channel);
-  Serial.println(" selected.");
+uint8_t I2C_GetChannelMask(uint8_t muxAddress) {
+  MuxState* mux = findMux(muxAddress);
+  return (mux != nullptr) ? mux->selected : 0x00;
 }
 
-// Function to disable all channels on the PCA9548A I2C multiplexer
-void I2C_DisableAllChannels(uint8_t muxAddress) {
-  // Use the I2C_WR function from I2C_FCTNS to send a control byte of 0x00
-  I2C_WR(muxAddress, 0x00);
+// Function to record that NRESET has put every multiplexer back to all channels off
+void I2C_MuxResetAll() {
+  for (uint8_t index = 0; index < I2C_MUX_MAX_COUNT; index++) {
+    muxStates[index].held = 0x00;
+    muxStates[index].known = true;
+  }
+  MUX_TRACE(" and the rest reset to 0b", I2C_MUX_BASE_ADDRESS, 0);
+}
 
-  // Update the currently active channel to indicate no channel is active
-  currentChannel = -1;
+void I2C_MuxInvalidate(uint8_t muxAddress) {
+  MuxState* mux = findMux(muxAddress);
+  if (mux != nullptr) {
+    mux->known = false;
+  }
+}
 
-  Serial.println("\nI2C Multiplexer: All channels disabled.");
-}
\ No newline at end of file
+// Function to put a multiplexer back into the state callers last selected
+void I2C_MuxResync(uint8_t muxAddress) {
+  MuxState* mux = findMux(muxAddress);
+  if (mux != nullptr) {
+    writeControl(muxAddress, *mux, mux->selected);
+  }
+}
@@ -0,0 +1,635 @@
+// I2C_Queue.cpp
+// -------------
+// Implementation of the interrupt-driven I2C transaction queue.
+// Each job is turned into a stream of LPI2C commands (START, transmit, receive, STOP) that the
+// interrupt feeds into the 4 word command FIFO as it empties. Received bytes are drained from the
+// receive FIFO in the same interrupt, and the job completes when its final STOP has been detected.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include <Wire.h>
+#include "I2C_Queue.h"
+#include "I2C_DeviceStats.h" // Per-device statistics recorded as jobs complete
+#include "I2C_MUX.h" // Multiplexer address, to tag devices with the channels open
+
+#define LPI2C_FIFO_DEPTH 4
+#define LPI2C_MFSR_TXCOUNT(mfsr) ((mfsr) & 0x07)
+
+// Status flags cleared by writing them back
+#define LPI2C_STATUS_FLAGS (LPI2C_MSR_EPF | LPI2C_MSR_SDF | LPI2C_MSR_NDF | LPI2C_MSR_ALF | LPI2C_MSR_FEF | LPI2C_MSR_PLTF)
+#define LPI2C_ERROR_FLAGS (LPI2C_MSR_ALF | LPI2C_MSR_FEF | LPI2C_MSR_PLTF)
+
+// Longest command stream: START, the written bytes, STOP, START, RECEIVE, STOP
+#define I2C_MAX_COMMANDS (I2C_JOB_MAX_DATA + 5)
+
+struct I2C_BusState {
+    IMXRT_LPI2C_t* port;
+    IRQ_NUMBER_t irq;
+    I2C_Job jobs[I2C_QUEUE_LENGTH];
+    volatile uint8_t head;  // next slot to fill
+    volatile uint8_t tail;  // slot of the job on the bus, or the next one to start
+    volatile bool busy;     // a job is on the bus
+    uint32_t nextTicket;
+
+    // Command stream of the job on the bus
+    uint16_t commands[I2C_MAX_COMMANDS];
+    uint8_t commandCount;
+    uint8_t commandIndex;
+    uint8_t rxIndex;
+    uint8_t stopsExpected;
+    bool nacked;
+
+    uint32_t clockHz;  // restored after a timeout resets the peripheral
+    uint8_t muxMask;   // multiplexer channels opened by the last successful control byte
+    volatile bool suspended;        // nothing is started while the bus is being recovered
+    volatile bool recoveryNeeded;   // set by jobs failing with a bus level error
+    bool dryRun;                    // jobs complete on the spot without touching the peripheral
+    I2C_DryRunStats dryRunStats;
+
+    // Activity counters
+    volatile uint8_t depth;
+    uint8_t maxDepth;
+    uint32_t jobStart;
+    volatile uint32_t busyMicros;
+    volatile uint32_t jobsCompleted;
+    volatile uint32_t jobsFailed;
+    uint32_t statsStart;
+};
+
+static I2C_BusState buses[I2C_BUS_COUNT];
+static bool queueStarted = false;
+static I2C_RecoveryHandler recoveryHandler = nullptr;
+
+
+// Masks every interrupt while the ring is changed from outside the bus interrupt. Jobs are queued from
+// other interrupts too (the BMS RDY pin queues its reads on Wire1), and masking only the bus interrupt
+// would let one of them preempt a caller half way through updating the ring. The previous mask is
+// restored, so this nests inside interrupts and job callbacks.
+static inline uint32_t lockQueue() {
+    uint32_t primask;
+    __asm__ volatile("mrs %0, primask" : "=r"(primask));
+    __disable_irq();
+    return primask;
+}
+
+static inline void unlockQueue(uint32_t primask) {
+    if (!(primask & 1)) {
+        __enable_irq();
+    }
+}
+
+
+// Builds the command stream of the job at the tail and hands it to the interrupt.
+// Called with the queue locked or from the bus interrupt.
+static void startJob(I2C_BusState& bus) {
+    I2C_Job& job = bus.jobs[bus.tail];
+    uint8_t count = 0;
+
+    if (job.txLength > 0) {
+        bus.commands[count++] = LPI2C_MTDR_CMD_START | (job.address << 1);
+        for (uint8_t i = 0; i < job.txLength; i++) {
+            bus.commands[count++] = LPI2C_MTDR_CMD_TRANSMIT | job.txData[i];
+        }
+    }
+    bus.stopsExpected = 1;
+    if (job.rxLength > 0) {
+        if (job.txLength > 0 && (job.flags & I2C_FLAG_STOP_BEFORE_READ)) {
+            bus.commands[count++] = LPI2C_MTDR_CMD_STOP;
+            bus.stopsExpected = 2;
+        }
+        bus.commands[count++] = LPI2C_MTDR_CMD_START | (job.address << 1) | 1;
+        bus.commands[count++] = LPI2C_MTDR_CMD_RECEIVE | (job.rxLength - 1);
+    }
+    bus.commands[count++] = LPI2C_MTDR_CMD_STOP;
+
+    bus.commandCount = count;
+    bus.commandIndex = 0;
+    bus.rxIndex = 0;
+    bus.nacked = false;
+    bus.busy = true;
+    bus.jobStart = micros();
+    job.state = I2C_JOB_ACTIVE;
+
+    // The transmit interrupt fires straight away as the command FIFO is empty
+    bus.port->MSR = LPI2C_STATUS_FLAGS;
+    bus.port->MIER = LPI2C_MIER_TDIE | LPI2C_MIER_SDIE | LPI2C_MIER_NDIE | LPI2C_MIER_ALIE |
+                     LPI2C_MIER_FEIE | LPI2C_MIER_PLTIE | (job.rxLength > 0 ? LPI2C_MIER_RDIE : 0);
+}
+
+static void finishJob(I2C_BusState& bus, I2C_Status status) {
+    I2C_Job& job = bus.jobs[bus.tail];
+    uint32_t latency = micros() - bus.jobStart;
+
+    bus.port->MIER = 0;
+    job.status = status;
+    job.state = (status == I2C_OK) ? I2C_JOB_DONE : I2C_JOB_FAILED;
+    bus.busy = false;
+    bus.busyMicros += latency;
+    bus.depth--;
+    if (status == I2C_OK) {
+        bus.jobsCompleted++;
+    } else {
+        bus.jobsFailed++;
+    }
+    if (status == I2C_ERROR_TIMEOUT || status == I2C_ERROR_BUS || status == I2C_ERROR_ARBITRATION) {
+        bus.recoveryNeeded = true;
+    }
+
+    // Follow the multiplexer so devices sharing an address behind it are recorded separately
+    bool muxControl = (&bus == &buses[I2C_BUS_WIRE]) && job.address == I2C_MUX_ADDRESS && job.txLength == 1 && job.rxLength == 0;
+    I2C_RecordTransaction(&bus - buses, job.address, muxControl ? 0 : bus.muxMask, status, latency);
+    if (muxControl && status == I2C_OK) {
+        bus.muxMask = job.txData[0];
+    }
+    bus.tail = (bus.tail + 1) % I2C_QUEUE_LENGTH;
+
+    if (job.callback != nullptr) {
+        job.callback(job); // may queue further jobs
+    }
+    if (!bus.busy && !bus.suspended && bus.jobs[bus.tail].state == I2C_JOB_QUEUED) {
+        startJob(bus);
+    }
+}
+
+static void serviceBus(I2C_BusState& bus) {
+    IMXRT_LPI2C_t* port = bus.port;
+    uint32_t status = port->MSR;
+
+    if (!bus.busy) {
+        port->MIER = 0;
+        return;
+    }
+    I2C_Job& job = bus.jobs[bus.tail];
+
+    // Drain the receive FIFO
+    while (true) {
+        uint32_t word = port->MRDR;
+        if (word & LPI2C_MRDR_RXEMPTY) {
+            break;
+        }
+        if (bus.rxIndex < job.rxLength) {
+            job.rxData[bus.rxIndex++] = word & 0xFF;
+        }
+    }
+
+    // Arbitration lost or a FIFO or pin error, the job is abandoned
+    if (status & LPI2C_ERROR_FLAGS) {
+        port->MCR |= LPI2C_MCR_RTF | LPI2C_MCR_RRF;
+        port->MSR = LPI2C_STATUS_FLAGS;
+        finishJob(bus, (status & LPI2C_MSR_ALF) ? I2C_ERROR_ARBITRATION : I2C_ERROR_BUS);
+        return;
+    }
+
+    // Not acknowledged, drop the rest of the job and end it with a STOP
+    if ((status & LPI2C_MSR_NDF) && !bus.nacked) {
+        port->MSR = LPI2C_MSR_NDF;
+        port->MCR |= LPI2C_MCR_RTF | LPI2C_MCR_RRF;
+        port->MTDR = LPI2C_MTDR_CMD_STOP;
+        bus.nacked = true;
+        bus.commandIndex = bus.commandCount;
+        bus.stopsExpected = 1;
+    }
+
+    // Keep the command FIFO topped up
+    while (bus.commandIndex < bus.commandCount && LPI2C_MFSR_TXCOUNT(port->MFSR) < LPI2C_FIFO_DEPTH) {
+        port->MTDR = bus.commands[bus.commandIndex++];
+    }
+    if (bus.commandIndex >= bus.commandCount) {
+        port->MIER &= ~LPI2C_MIER_TDIE;
+    }
+
+    if (status & LPI2C_MSR_SDF) {
+        port->MSR = LPI2C_MSR_SDF;
+        if (--bus.stopsExpected == 0) {
+            if (bus.nacked) {
+                finishJob(bus, I2C_ERROR_NACK);
+            } else {
+                finishJob(bus, bus.rxIndex == job.rxLength ? I2C_OK : I2C_ERROR_BUS);
+            }
+        }
+    }
+}
+
+static void lpi2c1Isr() {
+    serviceBus(buses[I2C_BUS_WIRE]);
+}
+
+static void lpi2c3Isr() {
+    serviceBus(buses[I2C_BUS_WIRE1]);
+}
+
+// Rewrites the timing registers for the bus clock, setClock() also restarts the peripheral.
+// Called with the queue locked.
+static void applyClock(I2C_BusState& bus) {
+    if (&bus == &buses[I2C_BUS_WIRE]) {
+        Wire.setClock(bus.clockHz);
+    } else {
+        Wire1.setClock(bus.clockHz);
+    }
+    bus.port->MIER = 0;
+    bus.port->MFCR = LPI2C_MFCR_TXWATER(1) | LPI2C_MFCR_RXWATER(0);
+    bus.port->MSR = LPI2C_STATUS_FLAGS;
+}
+
+// Resets the master logic, which clears the FIFOs and the state machine, and fails the job on the bus.
+// Called with the queue locked.
+static void abortJob(I2C_BusState& bus, I2C_Status status) {
+    bus.port->MIER = 0;
+    bus.port->MCR = LPI2C_MCR_RST;
+    bus.port->MCR = 0;
+    applyClock(bus);
+    finishJob(bus, status);
+}
+
+// Aborts the job on the bus if it has overrun its timeout, so the ring moves on
+static void checkTimeout(I2C_BusState& bus) {
+    uint32_t primask = lockQueue();
+    if (bus.busy && micros() - bus.jobStart > bus.jobs[bus.tail].timeoutMicros) {
+        abortJob(bus, I2C_ERROR_TIMEOUT);
+    }
+    unlockQueue(primask);
+}
+
+// Bits a job puts on the wire: START, address and data bytes with their ACKs, STOP, and the same again
+// for the read
+static uint32_t jobBits(const I2C_Job& job) {
+    uint32_t bits = 1; // STOP
+    if (job.txLength > 0) {
+        bits += 1 + 9 * (1 + job.txLength);
+        if (job.rxLength > 0 && (job.flags & I2C_FLAG_STOP_BEFORE_READ)) {
+            bits += 1;
+        }
+    }
+    if (job.rxLength > 0) {
+        bits += 1 + 9 * (1 + job.rxLength);
+    }
+    return bits;
+}
+
+// Completes the job at the head of a dry run bus as if every device had acknowledged it.
+// Called with the queue locked.
+static void finishDryRun(I2C_BusState& bus, I2C_Job& job) {
+    memset(job.rxData, 0, job.rxLength);
+    job.status = I2C_OK;
+    job.state = I2C_JOB_DONE;
+    bus.head = (bus.head + 1) % I2C_QUEUE_LENGTH;
+    bus.tail = bus.head;
+
+    bus.dryRunStats.jobs++;
+    bus.dryRunStats.bits += jobBits(job);
+    if (&bus == &buses[I2C_BUS_WIRE] && job.address == I2C_MUX_ADDRESS && job.txLength == 1 && job.rxLength == 0) {
+        bus.dryRunStats.muxWrites++;
+        bus.muxMask = job.txData[0];
+    }
+}
+
+// Twice the time the job takes on the bus at the current clock, plus a margin
+static uint32_t defaultTimeout(const I2C_BusState& bus, uint8_t txLength, uint8_t rxLength) {
+    uint32_t bits = (txLength + rxLength + 2) * 9 + 4; // address bytes, data bytes, starts and stops
+    return (2 * bits * 1000000UL) / bus.clockHz + I2C_TIMEOUT_MARGIN_US;
+}
+
+
+void I2C_QueueBegin() {
+    if (queueStarted) {
+        return;
+    }
+    buses[I2C_BUS_WIRE].port = &IMXRT_LPI2C1;
+    buses[I2C_BUS_WIRE].irq = IRQ_LPI2C1;
+    buses[I2C_BUS_WIRE1].port = &IMXRT_LPI2C3;
+    buses[I2C_BUS_WIRE1].irq = IRQ_LPI2C3;
+
+    for (uint8_t i = 0; i < I2C_BUS_COUNT; i++) {
+        I2C_BusState& bus = buses[i];
+        bus.nextTicket = 1;
+        bus.statsStart = micros();
+        bus.clockHz = 100000; // Wire.begin() default
+
+        // Interrupt when the command FIFO is down to one word, or anything has been received
+        bus.port->MIER = 0;
+        bus.port->MFCR = LPI2C_MFCR_TXWATER(1) | LPI2C_MFCR_RXWATER(0);
+        bus.port->MSR = LPI2C_STATUS_FLAGS;
+        NVIC_SET_PRIORITY(bus.irq, 128);
+    }
+    attachInterruptVector(IRQ_LPI2C1, lpi2c1Isr);
+    attachInterruptVector(IRQ_LPI2C3, lpi2c3Isr);
+    NVIC_ENABLE_IRQ(IRQ_LPI2C1);
+    NVIC_ENABLE_IRQ(IRQ_LPI2C3);
+
+    queueStarted = true;
+}
+
+uint32_t I2C_Enqueue(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength, uint8_t rxLength,
+                     I2C_Callback callback, void* context, uint8_t flags, uint32_t timeoutMicros) {
+    if (bus >= I2C_BUS_COUNT || txLength > I2C_JOB_MAX_DATA || rxLength > I2C_JOB_MAX_DATA ||
+        (txLength == 0 && rxLength == 0)) {
+        return 0;
+    }
+    I2C_QueueBegin();
+
+    I2C_BusState& state = buses[bus];
+    uint32_t primask = lockQueue();
+
+    I2C_Job& job = state.jobs[state.head];
+    if (job.state == I2C_JOB_QUEUED || job.state == I2C_JOB_ACTIVE) {
+        unlockQueue(primask);
+        return 0; // ring full
+    }
+
+    job.ticket = state.nextTicket++;
+    if (state.nextTicket == 0) {
+        state.nextTicket = 1; // 0 is reserved for failures
+    }
+    job.address = address;
+    job.flags = flags;
+    job.txLength = txLength;
+    job.rxLength = rxLength;
+    if (txLength > 0) {
+        memcpy(job.txData, txData, txLength);
+    }
+    job.callback = callback;
+    job.context = context;
+    job.timeoutMicros = (timeoutMicros != 0) ? timeoutMicros : defaultTimeout(state, txLength, rxLength);
+    if (state.dryRun) {
+        finishDryRun(state, job);
+        uint32_t ticket = job.ticket;
+        unlockQueue(primask);
+        if (callback != nullptr) {
+            callback(job);
+        }
+        return ticket;
+    }
+    job.status = I2C_OK;
+    job.state = I2C_JOB_QUEUED;
+    state.head = (state.head + 1) % I2C_QUEUE_LENGTH;
+    if (++state.depth > state.maxDepth) {
+        state.maxDepth = state.depth;
+    }
+
+    if (!state.busy && !state.suspended) {
+        startJob(state);
+    }
+    uint32_t ticket = job.ticket;
+
+    unlockQueue(primask);
+    return ticket;
+}
+
+uint32_t I2C_EnqueueWaiting(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength, uint8_t rxLength,
+                            I2C_Callback callback, void* context, uint8_t flags) {
+    if (bus >= I2C_BUS_COUNT || txLength > I2C_JOB_MAX_DATA || rxLength > I2C_JOB_MAX_DATA ||
+        (txLength == 0 && rxLength == 0)) {
+        return 0;
+    }
+    uint32_t ticket;
+    while ((ticket = I2C_Enqueue(bus, address, txData, txLength, rxLength, callback, context, flags)) == 0) {
+        checkTimeout(buses[bus]);
+    }
+    return ticket;
+}
+
+uint32_t I2C_WriteAsync(uint8_t bus, uint8_t address, uint8_t registerAddress, uint8_t dataByte,
+                        I2C_Callback callback, void* context) {
+    const uint8_t txData[] = {registerAddress, dataByte};
+    return I2C_EnqueueWaiting(bus, address, txData, sizeof(txData), 0, callback, context, 0);
+}
+
+// Slot holding a ticket, null once the slot has been reused
+static I2C_Job* findJob(uint8_t bus, uint32_t ticket) {
+    if (bus >= I2C_BUS_COUNT || ticket == 0) {
+        return nullptr;
+    }
+    for (uint8_t i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        if (buses[bus].jobs[i].ticket == ticket) {
+            return &buses[bus].jobs[i];
+        }
+    }
+    return nullptr;
+}
+
+I2C_JobState I2C_JobStatus(uint8_t bus, uint32_t ticket) {
+    I2C_Job* job = findJob(bus, ticket);
+    return (job != nullptr) ? job->state : I2C_JOB_EXPIRED;
+}
+
+I2C_Status I2C_Wait(uint8_t bus, uint32_t ticket, uint8_t* rxData) {
+    I2C_Job* job = findJob(bus, ticket);
+    if (job == nullptr) {
+        return I2C_ERROR_EXPIRED;
+    }
+    while (job->state == I2C_JOB_QUEUED || job->state == I2C_JOB_ACTIVE) {
+        checkTimeout(buses[bus]); // the interrupt moves the job along, this catches the ones that stall
+    }
+    if (job->ticket != ticket) {
+        return I2C_ERROR_EXPIRED; // reused while waiting
+    }
+    if (rxData != nullptr && job->rxLength > 0) {
+        memcpy(rxData, job->rxData, job->rxLength);
+    }
+    return job->status;
+}
+
+I2C_Status I2C_Transfer(uint8_t bus, uint8_t address, const uint8_t* txData, uint8_t txLength,
+                        uint8_t* rxData, uint8_t rxLength, uint8_t flags) {
+    if (bus >= I2C_BUS_COUNT || txLength > I2C_JOB_MAX_DATA || rxLength > I2C_JOB_MAX_DATA ||
+        (txLength == 0 && rxLength == 0)) {
+        return I2C_ERROR_INVALID;
+    }
+
+    I2C_Status status = I2C_OK;
+    for (uint8_t attempt = 0; attempt <= I2C_RETRY_LIMIT; attempt++) {
+        uint32_t ticket = I2C_EnqueueWaiting(bus, address, txData, txLength, rxLength, nullptr, nullptr, flags);
+        status = I2C_Wait(bus, ticket, rxData);
+        if (status == I2C_OK || status == I2C_ERROR_EXPIRED) {
+            break;
+        }
+        if (recoveryHandler != nullptr && attempt < I2C_RETRY_LIMIT &&
+            (status == I2C_ERROR_TIMEOUT || status == I2C_ERROR_BUS || status == I2C_ERROR_ARBITRATION)) {
+            recoveryHandler(bus); // free the bus before trying again
+        }
+    }
+    return status;
+}
+
+const char* I2C_StatusName(I2C_Status status) {
+    switch (status) {
+        case I2C_OK:                return "ok";
+        case I2C_ERROR_NACK:        return "not acknowledged";
+        case I2C_ERROR_ARBITRATION: return "arbitration lost";
+        case I2C_ERROR_BUS:         return "bus error";
+        case I2C_ERROR_TIMEOUT:     return "timeout";
+        case I2C_ERROR_QUEUE_FULL:  return "queue full";
+        case I2C_ERROR_EXPIRED:     return "expired";
+        default:                    return "invalid";
+    }
+}
+
+bool I2C_Idle(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return true;
+    }
+    return !buses[bus].busy && buses[bus].jobs[buses[bus].tail].state != I2C_JOB_QUEUED;
+}
+
+void I2C_WaitIdle(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    while (!I2C_Idle(bus)) {
+        checkTimeout(buses[bus]); // the interrupt works through the ring, this catches the jobs that stall
+    }
+}
+
+void I2C_SetClock(uint8_t bus, uint32_t clockHz) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    I2C_QueueBegin();
+    I2C_BusState& state = buses[bus];
+
+    // Only change the timing between jobs, retrying if a job was queued from an interrupt meanwhile
+    uint32_t primask;
+    while (true) {
+        I2C_WaitIdle(bus);
+        primask = lockQueue();
+        if (I2C_Idle(bus)) {
+            break;
+        }
+        unlockQueue(primask);
+    }
+
+    state.clockHz = clockHz;
+    applyClock(state);
+
+    unlockQueue(primask);
+}
+
+bool I2C_RecoveryNeeded(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT || !queueStarted) {
+        return false;
+    }
+    return buses[bus].recoveryNeeded || I2C_BusHeld(bus);
+}
+
+bool I2C_BusHeld(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT || !queueStarted) {
+        return false;
+    }
+    const I2C_BusState& state = buses[bus];
+    // An idle master that still sees the bus busy has a device holding SDA low
+    return !state.busy && !state.suspended && (state.port->MSR & LPI2C_MSR_BBF);
+}
+
+void I2C_RequestRecovery(uint8_t bus) {
+    if (bus < I2C_BUS_COUNT) {
+        buses[bus].recoveryNeeded = true;
+    }
+}
+
+void I2C_ClearRecoveryRequest(uint8_t bus) {
+    if (bus < I2C_BUS_COUNT) {
+        buses[bus].recoveryNeeded = false;
+    }
+}
+
+void I2C_SuspendBus(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    I2C_QueueBegin();
+    I2C_BusState& state = buses[bus];
+
+    uint32_t primask = lockQueue();
+    state.suspended = true;
+    if (state.busy) {
+        abortJob(state, I2C_ERROR_BUS);
+    }
+    unlockQueue(primask);
+}
+
+void I2C_ResumeBus(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    I2C_BusState& state = buses[bus];
+
+    uint32_t primask = lockQueue();
+    // begin() hands the pins back to the peripheral after they were driven as GPIO
+    if (bus == I2C_BUS_WIRE) {
+        Wire.begin();
+    } else {
+        Wire1.begin();
+    }
+    applyClock(state);
+    state.suspended = false;
+    state.recoveryNeeded = false;
+    if (!state.busy && state.jobs[state.tail].state == I2C_JOB_QUEUED) {
+        startJob(state);
+    }
+    unlockQueue(primask);
+}
+
+void I2C_SetDryRun(uint8_t bus, bool enabled) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    I2C_QueueBegin();
+    I2C_BusState& state = buses[bus];
+    I2C_WaitIdle(bus);
+
+    uint32_t primask = lockQueue();
+    state.dryRun = enabled;
+    memset(&state.dryRunStats, 0, sizeof(state.dryRunStats));
+    unlockQueue(primask);
+}
+
+I2C_DryRunStats I2C_GetDryRunStats(uint8_t bus) {
+    I2C_DryRunStats stats = {};
+    if (bus < I2C_BUS_COUNT) {
+        stats = buses[bus].dryRunStats;
+    }
+    return stats;
+}
+
+bool I2C_IsDryRun(uint8_t bus) {
+    return bus < I2C_BUS_COUNT && buses[bus].dryRun;
+}
+
+void I2C_SetRecoveryHandler(I2C_RecoveryHandler handler) {
+    recoveryHandler = handler;
+}
+
+I2C_BusStats I2C_GetBusStats(uint8_t bus) {
+    I2C_BusStats stats = {};
+    if (bus >= I2C_BUS_COUNT) {
+        return stats;
+    }
+    const I2C_BusState& state = buses[bus];
+    stats.jobsCompleted = state.jobsCompleted;
+    stats.jobsFailed = state.jobsFailed;
+    stats.queueDepth = state.depth;
+    stats.maxQueueDepth = state.maxDepth;
+    stats.busyMicros = state.busyMicros;
+    stats.windowMicros = micros() - state.statsStart;
+    stats.utilisation = (stats.windowMicros > 0) ? (float)stats.busyMicros / stats.windowMicros : 0.0f;
+    return stats;
+}
+
+void I2C_ResetBusStats(uint8_t bus) {
+    if (bus >= I2C_BUS_COUNT) {
+        return;
+    }
+    I2C_BusState& state = buses[bus];
+    uint32_t primask = lockQueue();
+    state.jobsCompleted = 0;
+    state.jobsFailed = 0;
+    state.maxDepth = state.depth;
+    state.busyMicros = 0;
+    state.statsStart = micros();
+    unlockQueue(primask);
+}
@@ -0,0 +1,267 @@
+// I2C_Recovery.cpp
+// ----------------
+// Implementation of the I2C bus recovery.
+// While the pins are driven as GPIO, SCL is an open drain output and SDA is read back after every
+// pulse. The STOP is made by releasing SDA while SCL is high, which also ends any transfer a device
+// still thinks is in progress.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "I2C_Recovery.h"
+#include "PinAssignments.h"
+#include "I2C_MUX.h"
+#include "MotorDriver_LP3943.h"
+#include "MotorDriver_Registry.h"
+#include "MotorDriver_Shadow.h"
+
+struct BusPins {
+    uint8_t sda;
+    uint8_t scl;
+};
+
+static const BusPins busPins[I2C_BUS_COUNT] = {
+    {I2C_SDA_PIN, I2C_SCL_PIN},   // Wire
+    {I2C1_SDA_PIN, I2C1_SCL_PIN}, // Wire1
+};
+
+static I2C_RecoveryStats recoveryStats[I2C_BUS_COUNT];
+static I2C_RecoveryResult lastResults[I2C_BUS_COUNT];
+static uint8_t recoveryDriverAddress = 0x60;
+static bool recovering = false;      // stops recovery being re-entered by its own transfers
+static uint8_t simulatedHoldPulses = 0; // test only, SDA is held low for this many pulses
+
+// Commanded state of the drivers being re-initialised, by channel and address index
+static uint8_t savedMasks[SHADOW_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT];
+static uint8_t savedValues[SHADOW_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT][SHADOW_REGISTER_COUNT];
+
+
+// Clocks SCL until SDA is released. Returns the pulses it took, SDA is left released.
+static uint8_t clockOutStuckDevice(const BusPins& pins) {
+    pinMode(pins.scl, OUTPUT_OPENDRAIN);
+    digitalWrite(pins.scl, HIGH);
+    if (simulatedHoldPulses > 0) {
+        pinMode(pins.sda, OUTPUT_OPENDRAIN); // stand in for the stuck device
+        digitalWrite(pins.sda, LOW);
+    } else {
+        pinMode(pins.sda, INPUT_PULLUP);
+    }
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+
+    uint8_t pulses = 0;
+    while (pulses < I2C_RECOVERY_MAX_PULSES && digitalRead(pins.sda) == LOW) {
+        digitalWrite(pins.scl, LOW);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+        digitalWrite(pins.scl, HIGH);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+        pulses++;
+
+        if (simulatedHoldPulses > 0 && pulses >= simulatedHoldPulses) {
+            pinMode(pins.sda, INPUT_PULLUP); // the simulated device lets go
+            simulatedHoldPulses = 0;
+        }
+    }
+    return pulses;
+}
+
+// STOP: SDA goes low while SCL is low, then rises while SCL is high
+static void sendStop(const BusPins& pins) {
+    digitalWrite(pins.scl, LOW);
+    pinMode(pins.sda, OUTPUT_OPENDRAIN);
+    digitalWrite(pins.sda, LOW);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    digitalWrite(pins.scl, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    digitalWrite(pins.sda, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+}
+
+// The PCA9548A resets to all channels off, releasing any downstream bus it was passing through
+static void resetMultiplexer() {
+    digitalWrite(NRESET, LOW);
+    delayMicroseconds(1); // reset pulse is a few ns minimum
+    digitalWrite(NRESET, HIGH);
+    delayMicroseconds(1);
+    I2C_MuxResetAll();
+}
+
+// True when the bus is actually stuck: the master is idle but sees it busy, or with nothing on the bus
+// a device holds SDA or SCL low. A job that failed on a free bus is only retried, as recovery
+// re-initialises the drivers and briefly turns their outputs off.
+static bool busHeld(uint8_t bus) {
+    if (simulatedHoldPulses > 0) {
+        return true; // the test stands in for the stuck device
+    }
+    const BusPins& pins = busPins[bus];
+    return I2C_BusHeld(bus) ||
+           (I2C_Idle(bus) && (digitalRead(pins.sda) == LOW || digitalRead(pins.scl) == LOW));
+}
+
+// Keeps what every driver on the channels was last commanded, before re-initialisation overwrites it
+static void saveCommandedState(uint8_t channelMask) {
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            savedMasks[mux_channel][index] = (channelMask & (1 << mux_channel)) ?
+                shadowGetCommanded(mux_channel, SHADOW_ADDRESS_BASE + index, savedValues[mux_channel][index]) : 0;
+        }
+    }
+}
+
+// Writes the saved state back to the re-initialised drivers, so the motors carry on as commanded.
+// Registers the initialisation left as they were are elided by the shadow. Returns the drivers written.
+static uint8_t restoreCommandedState() {
+    uint8_t restored = 0;
+    uint32_t commandStart = micros();
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            uint8_t mask = savedMasks[mux_channel][index];
+            if (mask == 0) {
+                continue;
+            }
+            uint8_t address = SHADOW_ADDRESS_BASE + index;
+            for (uint8_t n = 0; n < SHADOW_REGISTER_COUNT; n++) {
+                if (mask & (1 << n)) {
+                    shadowStage(mux_channel, address, SHADOW_FIRST_REGISTER + n, savedValues[mux_channel][index][n]);
+                }
+            }
+            if (motorDriverFlush(mux_channel, address, commandStart) > 0) {
+                restored++;
+            }
+        }
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    return restored;
+}
+
+// Retry handler of I2C_Transfer()
+static void recoverBeforeRetry(uint8_t bus) {
+    if (!recovering && busHeld(bus)) {
+        I2C_RecoverBus(bus);
+    }
+}
+
+
+void I2C_RecoveryBegin(uint8_t driverAddress) {
+    recoveryDriverAddress = driverAddress;
+    I2C_SetRecoveryHandler(recoverBeforeRetry);
+}
+
+I2C_RecoveryResult I2C_RecoverBus(uint8_t bus) {
+    I2C_RecoveryResult result = {false, 0, I2C_OK, 0, 0};
+    if (bus >= I2C_BUS_COUNT || recovering) {
+        result.reinitStatus = I2C_ERROR_INVALID;
+        return result;
+    }
+    uint32_t start = micros();
+    recovering = true;
+
+    const BusPins& pins = busPins[bus];
+    uint8_t openChannels = I2C_GetChannelMask(I2C_MUX_ADDRESS);
+
+    I2C_SuspendBus(bus);
+    result.clockPulses = clockOutStuckDevice(pins);
+    result.released = digitalRead(pins.sda) == HIGH;
+    sendStop(pins);
+    if (bus == I2C_BUS_WIRE) {
+        resetMultiplexer();
+    }
+    I2C_ResumeBus(bus);
+
+    if (bus == I2C_BUS_WIRE) {
+        // Re-initialise the drivers that were reachable when the bus locked up, all of them if none were
+        uint8_t affected = (openChannels != 0) ? openChannels : I2C_MUX_ALL_CHANNELS;
+        saveCommandedState(affected);
+        if (getRegisteredDriverCount() > 0) {
+            result.reinitStatus = initRegisteredDrivers(affected);
+        } else {
+            result.reinitStatus = motorDriverInitAll(affected, recoveryDriverAddress);
+        }
+        if (result.reinitStatus == I2C_OK) {
+            result.driversRestored = restoreCommandedState();
+        }
+        I2C_SelectChannelMask(I2C_MUX_ADDRESS, openChannels); // skipped if the multiplexer already holds it
+    }
+    recovering = false;
+    result.durationMicros = micros() - start;
+
+    I2C_RecoveryStats& stats = recoveryStats[bus];
+    stats.recoveries++;
+    if (!result.released || result.reinitStatus != I2C_OK) {
+        stats.failures++;
+    }
+    stats.lastMicros = result.durationMicros;
+    if (result.durationMicros > stats.maxMicros) {
+        stats.maxMicros = result.durationMicros;
+    }
+    lastResults[bus] = result;
+    return result;
+}
+
+bool I2C_ServiceRecovery() {
+    bool ran = false;
+    for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+        if (!I2C_RecoveryNeeded(bus)) {
+            continue;
+        }
+        if (busHeld(bus)) {
+            I2C_RecoveryResult result = I2C_RecoverBus(bus);
+            if (!result.released) {
+                Serial.print("Error: I2C bus ");
+                Serial.print(bus);
+                Serial.println(" still held low after recovery.");
+            }
+            ran = true;
+        } else if (I2C_Idle(bus)) {
+            I2C_ClearRecoveryRequest(bus); // free with nothing running, so the failure has passed
+        }
+    }
+    return ran;
+}
+
+I2C_RecoveryStats I2C_GetRecoveryStats(uint8_t bus) {
+    return recoveryStats[bus];
+}
+
+void I2C_ResetRecoveryStats() {
+    memset(recoveryStats, 0, sizeof(recoveryStats));
+}
+
+
+I2C_RecoveryTest I2C_TestRecovery(uint8_t holdPulses) {
+    I2C_RecoveryTest test = {};
+    if (holdPulses == 0 || holdPulses > I2C_RECOVERY_MAX_PULSES) {
+        test.recovery.reinitStatus = I2C_ERROR_INVALID;
+        return test;
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    uint8_t openChannels = I2C_GetChannelMask(I2C_MUX_ADDRESS);
+
+    // A failed job would normally flag the bus
+    simulatedHoldPulses = holdPulses;
+    I2C_RequestRecovery(I2C_BUS_WIRE);
+    uint32_t detected = micros();
+    bool ran = I2C_ServiceRecovery();
+    simulatedHoldPulses = 0;
+    if (!ran) {
+        return test;
+    }
+    test.recovery = lastResults[I2C_BUS_WIRE];
+
+    // Read the control register back, then time the first driver write once the bus is back
+    uint8_t controlByte = 0;
+    I2C_Status readStatus = I2C_Transfer(I2C_BUS_WIRE, I2C_MUX_ADDRESS, nullptr, 0, &controlByte, 1);
+    test.muxRestored = readStatus == I2C_OK && controlByte == openChannels;
+
+    uint8_t channel = (openChannels != 0) ? openChannels : I2C_MUX_ALL_CHANNELS;
+    test.resumeStatus = motorDriverMulticastWrite(channel, recoveryDriverAddress, 0x07, 0x55);
+    test.resumeMicros = micros() - detected;
+    I2C_SelectChannelMask(I2C_MUX_ADDRESS, openChannels);
+
+    test.passed = test.recovery.released && test.recovery.clockPulses == holdPulses &&
+                  test.recovery.reinitStatus == I2C_OK && test.muxRestored && test.resumeStatus == I2C_OK;
+    return test;
+}
@@ -0,0 +1,412 @@
+// MotorDriver_Frame.cpp
+// ---------------------
+// Implementation of the motor command frames.
+// A frame is a bit mask of the driver addresses touched on each channel, the register values
+// themselves are staged in the shadow.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "MotorDriver_Frame.h"
+#include "MotorDriver_LP3943.h"
+#include "MotorDriver_Shadow.h"
+
+static uint8_t frameDrivers[SHADOW_CHANNEL_COUNT]; // bit n set when address SHADOW_ADDRESS_BASE + n has commands
+// PWM banks feeding an output of each frame driver when it joined the frame, bit 0 for PWM0 and bit 1 for PWM1
+static uint8_t runningBanks[SHADOW_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT];
+static bool frameOpen = false;
+
+// Second phase multicast, drivers at one address switching to the same LS1 value
+struct SwitchGroup {
+    uint8_t address;
+    uint8_t value;
+    uint8_t channelMask;
+    volatile bool landed;
+    volatile uint32_t landTime; // micros() when the write completed, set in the I2C interrupt
+};
+
+static SwitchGroup switchGroups[SHADOW_CHANNEL_COUNT * SHADOW_ADDRESS_COUNT];
+
+// LS1 read back from each switched driver, by channel and address index, set in the I2C interrupt
+struct SwitchReadback {
+    volatile uint8_t value;
+    volatile bool read;
+};
+
+static SwitchReadback switchReadbacks[SHADOW_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT];
+
+struct SkewAccumulator {
+    uint32_t frames;
+    uint32_t lastSkew;
+    uint32_t maxSkew;
+    uint64_t skewSum;
+};
+
+static SkewAccumulator skewAccumulator;
+
+// First and last of a set of landing times, relative to the commit so they survive the micros() wrap
+struct LandingSpread {
+    uint8_t count;
+    uint32_t first;
+    uint32_t last;
+};
+
+
+// PWM banks the LS registers of a driver select for any output, as the driver holds them now.
+// An LS register the shadow does not know could select either.
+static uint8_t banksInUse(uint8_t mux_channel, uint8_t address) {
+    uint8_t banks = 0;
+    for (uint8_t registerAddress = 0x06; registerAddress <= 0x09; registerAddress++) {
+        uint8_t value;
+        if (!shadowGet(mux_channel, address, registerAddress, value)) {
+            return 0b11;
+        }
+        for (uint8_t shift = 0; shift < 8; shift += 2) {
+            uint8_t select = (value >> shift) & 0b11;
+            if (select == 0b10) {
+                banks |= 0b01; // PWM0
+            } else if (select == 0b11) {
+                banks |= 0b10; // PWM1
+            }
+        }
+    }
+    return banks;
+}
+
+// Adds a driver to the open frame, opening one if needed
+static bool addToFrame(uint8_t mux_channel, uint8_t address) {
+    if (!shadowCovers(mux_channel, address, SHADOW_FIRST_REGISTER)) {
+        Serial.println("Error: Motor frames only cover drivers 0x60-0x67 on channels 0-7.");
+        return false;
+    }
+    if (!frameOpen) {
+        motorFrameBegin();
+    }
+    uint8_t bit = 1 << (address - SHADOW_ADDRESS_BASE);
+    if (!(frameDrivers[mux_channel] & bit)) {
+        // Before anything is staged, so this is what the driver runs during the first phase
+        runningBanks[mux_channel][address - SHADOW_ADDRESS_BASE] = banksInUse(mux_channel, address);
+        frameDrivers[mux_channel] |= bit;
+    }
+    return true;
+}
+
+static void noteLanding(LandingSpread& spread, uint32_t landing) {
+    if (spread.count == 0 || landing < spread.first) {
+        spread.first = landing;
+    }
+    if (spread.count == 0 || landing > spread.last) {
+        spread.last = landing;
+    }
+    spread.count++;
+}
+
+// Channel the multiplexer holds on its own, so the frame can start there without a switch
+static uint8_t selectedChannel() {
+    uint8_t mask = I2C_GetChannelMask(I2C_MUX_ADDRESS);
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        if (mask == (1 << mux_channel)) {
+            return mux_channel;
+        }
+    }
+    return 0;
+}
+
+
+// Completion callback of a second phase multicast, runs in the I2C interrupt
+static void onSwitchWritten(const I2C_Job& job) {
+    SwitchGroup& group = *(SwitchGroup*)job.context;
+    group.landTime = micros();
+    group.landed = (job.state == I2C_JOB_DONE);
+}
+
+// Completion callback of an LS1 read back, runs in the I2C interrupt
+static void onSwitchRead(const I2C_Job& job) {
+    SwitchReadback& readback = *(SwitchReadback*)job.context;
+    readback.read = (job.state == I2C_JOB_DONE);
+    if (readback.read) {
+        readback.value = job.rxData[0];
+    }
+}
+
+// Reads LS1 back from every driver of the landed groups. A multicast is acknowledged if any driver
+// takes it, so this is what shows a single driver that missed it. Returns the drivers that do not
+// hold their new value, their shadow entries are invalidated.
+static uint8_t verifySwitchGroups(uint8_t groups) {
+    const uint8_t registerAddress = MOTOR_FRAME_SWITCH_REGISTER;
+    for (uint8_t group = 0; group < groups; group++) {
+        const SwitchGroup& switchGroup = switchGroups[group];
+        if (!switchGroup.landed) {
+            continue;
+        }
+        for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+            if (switchGroup.channelMask & (1 << mux_channel)) {
+                SwitchReadback& readback = switchReadbacks[mux_channel][switchGroup.address - SHADOW_ADDRESS_BASE];
+                readback.read = false;
+                I2C_SelectChannelMask(I2C_MUX_ADDRESS, 1 << mux_channel);
+                I2C_EnqueueWaiting(I2C_BUS_WIRE, switchGroup.address, &registerAddress, 1, 1, onSwitchRead, &readback);
+            }
+        }
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+
+    uint8_t mismatches = 0;
+    for (uint8_t group = 0; group < groups; group++) {
+        const SwitchGroup& switchGroup = switchGroups[group];
+        if (!switchGroup.landed) {
+            continue;
+        }
+        for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+            if (!(switchGroup.channelMask & (1 << mux_channel))) {
+                continue;
+            }
+            const SwitchReadback& readback = switchReadbacks[mux_channel][switchGroup.address - SHADOW_ADDRESS_BASE];
+            if (!readback.read || readback.value != switchGroup.value) {
+                shadowInvalidate(1 << mux_channel, switchGroup.address);
+                mismatches++;
+            }
+        }
+    }
+    return mismatches;
+}
+
+// Groups the staged LS1 values of the frame by address and value. Returns the number of groups.
+static uint8_t collectSwitchGroups() {
+    uint8_t count = 0;
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            uint8_t address = SHADOW_ADDRESS_BASE + index;
+            uint8_t value;
+            if (!(frameDrivers[mux_channel] & (1 << index)) ||
+                !shadowTakeRegister(mux_channel, address, MOTOR_FRAME_SWITCH_REGISTER, value)) {
+                continue;
+            }
+            uint8_t group = 0;
+            while (group < count && (switchGroups[group].address != address || switchGroups[group].value != value)) {
+                group++;
+            }
+            if (group == count) {
+                switchGroups[count].address = address;
+                switchGroups[count].value = value;
+                switchGroups[count].channelMask = 0;
+                count++;
+            }
+            switchGroups[group].channelMask |= 1 << mux_channel;
+        }
+    }
+    return count;
+}
+
+
+void motorFrameBegin() {
+    if (frameOpen) {
+        motorFrameAbort();
+    }
+    memset(frameDrivers, 0, sizeof(frameDrivers));
+    frameOpen = true;
+}
+
+bool motorFrameIsOpen() {
+    return frameOpen;
+}
+
+bool motorFrameMove(uint8_t mux_channel, uint8_t address, uint8_t speed, bool direction) {
+    if (!addToFrame(mux_channel, address)) {
+        return false;
+    }
+    stageVariableMotion(mux_channel, address, speed, direction);
+    return true;
+}
+
+bool motorFrameSetSpeeds(uint8_t mux_channel, uint8_t address, uint8_t speedOne, uint8_t speedTwo) {
+    if (!addToFrame(mux_channel, address)) {
+        return false;
+    }
+    stageMotionControl(mux_channel, address, speedOne, speedTwo);
+    return true;
+}
+
+bool motorFrameDefaultMove(uint8_t mux_channel, uint8_t address, uint8_t speedLevel, bool direction) {
+    if (!addToFrame(mux_channel, address)) {
+        return false;
+    }
+    stageDefaultMotion(mux_channel, address, speedLevel, direction);
+    return true;
+}
+
+bool motorFrameStop(uint8_t mux_channel, uint8_t address) {
+    if (!addToFrame(mux_channel, address)) {
+        return false;
+    }
+    stageMotorStop(mux_channel, address);
+    return true;
+}
+
+bool motorFrameSetOutput(uint8_t mux_channel, uint8_t address, uint8_t output, uint8_t speed) {
+    if (output >= MOTOR_DRIVER_OUTPUT_COUNT || !addToFrame(mux_channel, address)) {
+        return false;
+    }
+    stageOutputSpeed(mux_channel, address, output, speed);
+    return true;
+}
+
+MotorFrameResult motorFrameCommit(bool waitForLanding) {
+    MotorFrameResult result = {0, 0, 0, 0, 0};
+    uint32_t commitStart = micros();
+
+    // Channels in ascending order, wrapping round from the one already selected
+    uint8_t firstChannel = selectedChannel();
+    for (uint8_t step = 0; step < SHADOW_CHANNEL_COUNT; step++) {
+        uint8_t mux_channel = (firstChannel + step) % SHADOW_CHANNEL_COUNT;
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (!(frameDrivers[mux_channel] & (1 << index))) {
+                continue;
+            }
+            uint8_t maskBefore = I2C_GetChannelMask(I2C_MUX_ADDRESS);
+            result.bursts += motorDriverFlush(mux_channel, SHADOW_ADDRESS_BASE + index, commitStart);
+            if (I2C_GetChannelMask(I2C_MUX_ADDRESS) != maskBefore) {
+                result.channelSwitches++;
+            }
+            result.drivers++;
+        }
+    }
+    memset(frameDrivers, 0, sizeof(frameDrivers));
+    frameOpen = false;
+    result.queueMicros = micros() - commitStart;
+
+    if (waitForLanding) {
+        I2C_WaitIdle(I2C_BUS_WIRE);
+        result.landMicros = micros() - commitStart;
+    }
+    return result;
+}
+
+MotorSyncResult motorFrameCommitSynchronous() {
+    MotorSyncResult result = {};
+
+    // Only failures of this frame's bursts count, older ones have been handled by the shadow
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        takeMotorBurstFailures(mux_channel);
+    }
+    uint32_t commitStart = micros();
+
+    // First phase, everything but LS1, in channel order
+    const uint8_t stageMask = (uint8_t)~SHADOW_REGISTER_BIT(MOTOR_FRAME_SWITCH_REGISTER);
+    uint8_t firstChannel = selectedChannel();
+    for (uint8_t step = 0; step < SHADOW_CHANNEL_COUNT; step++) {
+        uint8_t mux_channel = (firstChannel + step) % SHADOW_CHANNEL_COUNT;
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (frameDrivers[mux_channel] & (1 << index)) {
+                result.stageBursts += motorDriverFlush(mux_channel, SHADOW_ADDRESS_BASE + index, commitStart, stageMask);
+                result.drivers++;
+            }
+        }
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    result.stageMicros = micros() - commitStart;
+
+    // Duty writes to a bank an output was already running from changed it as they landed
+    LandingSpread runningDuty = {0, 0, 0};
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (!(frameDrivers[mux_channel] & (1 << index))) {
+                continue;
+            }
+            for (uint8_t output = 0; output < MOTOR_DRIVER_OUTPUT_COUNT; output++) {
+                if (!(runningBanks[mux_channel][index] & (1 << output))) {
+                    continue;
+                }
+                // Relative to the commit, so writes elided or landed before it fall outside the phase
+                uint32_t landing = getMotorPWMWriteTime(mux_channel, SHADOW_ADDRESS_BASE + index, output) - commitStart;
+                if (landing <= result.stageMicros) {
+                    noteLanding(runningDuty, landing);
+                }
+            }
+        }
+    }
+    result.runningDutyWrites = runningDuty.count;
+
+    // A driver whose staging failed would switch onto stale duty cycles, so it is left out of the
+    // second phase. Its staged LS1 is dropped and becomes unknown.
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        uint8_t failed = takeMotorBurstFailures(mux_channel) & frameDrivers[mux_channel];
+        result.failedDrivers[mux_channel] = failed;
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (failed & (1 << index)) {
+                shadowDiscard(mux_channel, SHADOW_ADDRESS_BASE + index);
+                result.stageFailures++;
+            }
+        }
+        frameDrivers[mux_channel] &= ~failed;
+    }
+
+    // Second phase, nothing else is queued in between so the multicasts go out back to back
+    uint8_t groups = collectSwitchGroups();
+    for (uint8_t group = 0; group < groups; group++) {
+        SwitchGroup& switchGroup = switchGroups[group];
+        switchGroup.landed = false;
+        const uint8_t data[] = {MOTOR_FRAME_SWITCH_REGISTER, switchGroup.value};
+        I2C_SelectChannelMask(I2C_MUX_ADDRESS, switchGroup.channelMask);
+        I2C_EnqueueWaiting(I2C_BUS_WIRE, switchGroup.address, data, sizeof(data), 0, onSwitchWritten, &switchGroup);
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    result.landMicros = micros() - commitStart;
+    result.switchWrites = groups;
+
+    LandingSpread spread = runningDuty;
+    for (uint8_t group = 0; group < groups; group++) {
+        const SwitchGroup& switchGroup = switchGroups[group];
+        if (!switchGroup.landed) {
+            shadowInvalidate(switchGroup.channelMask, switchGroup.address);
+            result.switchFailures++;
+            continue;
+        }
+        noteLanding(spread, switchGroup.landTime - commitStart);
+    }
+    result.skewMicros = spread.last - spread.first;
+
+    // After the skew is taken, so the read back does not delay the switch
+    result.switchMismatches = verifySwitchGroups(groups);
+
+    memset(frameDrivers, 0, sizeof(frameDrivers));
+    frameOpen = false;
+
+    if (spread.count > 0) {
+        skewAccumulator.frames++;
+        skewAccumulator.lastSkew = result.skewMicros;
+        skewAccumulator.skewSum += result.skewMicros;
+        if (result.skewMicros > skewAccumulator.maxSkew) {
+            skewAccumulator.maxSkew = result.skewMicros;
+        }
+    }
+    return result;
+}
+
+MotorSkewStats getMotorSkewStats() {
+    MotorSkewStats stats = {skewAccumulator.frames, skewAccumulator.lastSkew, 0, skewAccumulator.maxSkew};
+    if (skewAccumulator.frames > 0) {
+        stats.meanSkew = (uint32_t)(skewAccumulator.skewSum / skewAccumulator.frames);
+    }
+    return stats;
+}
+
+void resetMotorSkewStats() {
+    memset(&skewAccumulator, 0, sizeof(skewAccumulator));
+}
+
+void motorFrameAbort() {
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (frameDrivers[mux_channel] & (1 << index)) {
+                shadowDiscard(mux_channel, SHADOW_ADDRESS_BASE + index);
+            }
+        }
+    }
+    memset(frameDrivers, 0, sizeof(frameDrivers));
+    frameOpen = false;
+}
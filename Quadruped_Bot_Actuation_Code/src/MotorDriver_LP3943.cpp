@@ -24,66 +24,230 @@
  #include "Wire.h"
  #include "I2C_FCT.h" // Include the I2C functions header file
  #include "I2C_MUX.h" // Include the I2C multiplexer functions header file
+ #include "I2C_Queue.h" // Include the background I2C transaction queue header file
+ #include "MotorDriver_Shadow.h" // Include the shadow register header file
+
+ #define LP3943_AUTO_INCREMENT 0x10 // register address bit that steps the address after each byte
+
+
+ // Register burst waiting to land, passed to the write's completion callback
+ struct BurstWrite {
+    uint8_t mux_channel;
+    uint8_t address;
+    uint8_t registers;     // shadow bits of the registers the burst carries
+    uint8_t outputs;       // bit n set when the burst carries the PWM register of output n
+    uint32_t commandStart; // micros() when the motion command was called
+ };
+
+ // Handed out in turn. No more bursts than the ring holds can be waiting, so a context is never
+ // reused while its job is still queued.
+ #define BURST_WRITE_SLOTS (2 * I2C_QUEUE_LENGTH)
+ static BurstWrite burstWrites[BURST_WRITE_SLOTS];
+ static uint8_t nextBurstWrite = 0;
+
+ // Drivers with a failed burst since they were last taken, bit n for address SHADOW_ADDRESS_BASE + n
+ static volatile uint8_t failedBursts[MOTOR_DRIVER_CHANNEL_COUNT];
+ // Actuation timing of every driver, by channel and address index
+ static volatile uint32_t pwmWriteTimes[MOTOR_DRIVER_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT][MOTOR_DRIVER_OUTPUT_COUNT];
+ static volatile uint32_t commandLatency[MOTOR_DRIVER_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT];
+
+ // True for the drivers the timing covers, addresses 0x60-0x67 on channels 0-7
+ static bool timingCovers(uint8_t mux_channel, uint8_t i2c_addr) {
+    return mux_channel < MOTOR_DRIVER_CHANNEL_COUNT &&
+           i2c_addr >= SHADOW_ADDRESS_BASE && i2c_addr < SHADOW_ADDRESS_BASE + SHADOW_ADDRESS_COUNT;
+ }
+
+ // Records when the PWM write of an output landed and folds the time since the command started into the latency
+ static void recordPWMWrite(uint8_t mux_channel, uint8_t i2c_addr, uint8_t output, uint32_t commandStart) {
+    if (!timingCovers(mux_channel, i2c_addr) || I2C_IsDryRun(I2C_BUS_WIRE)) {
+        return; // a simulated write never reached the motor
+    }
+    uint8_t index = i2c_addr - SHADOW_ADDRESS_BASE;
+    uint32_t now = micros();
+    pwmWriteTimes[mux_channel][index][output] = now;
+
+    uint32_t latency = now - commandStart;
+    volatile uint32_t& filtered = commandLatency[mux_channel][index];
+    if (filtered == 0) {
+        filtered = latency;
+    } else {
+        filtered += ((int32_t)(latency - filtered)) / 8; // 1/8 weight per command
+    }
+ }
+
+ // Completion callback of a queued register burst, runs in the I2C interrupt.
+ // The shadow counted the registers as written when they were queued, a failed burst takes that back.
+ static void onBurstWritten(const I2C_Job& job) {
+    const BurstWrite& burst = *(const BurstWrite*)job.context;
+    if (job.state != I2C_JOB_DONE) {
+        shadowWriteFailed(burst.mux_channel, burst.address, burst.registers);
+        failedBursts[burst.mux_channel] |= 1 << (burst.address - SHADOW_ADDRESS_BASE);
+        return;
+    }
+    for (uint8_t output = 0; output < MOTOR_DRIVER_OUTPUT_COUNT; output++) {
+        if (burst.outputs & (1 << output)) {
+            recordPWMWrite(burst.mux_channel, burst.address, output, burst.commandStart);
+        }
+    }
+ }
+
+ // Queues a burst of shadow registers to a driver on the selected channel, with the completion callback
+ static void queueBurst(uint8_t mux_channel, uint8_t i2c_addr, uint8_t firstRegister, const uint8_t* values,
+                        uint8_t length, uint32_t commandStart) {
+    uint8_t data[1 + SHADOW_REGISTER_COUNT];
+    data[0] = (length > 1) ? (LP3943_AUTO_INCREMENT | firstRegister) : firstRegister;
+    memcpy(&data[1], values, length);
+
+    BurstWrite& burst = burstWrites[nextBurstWrite];
+    nextBurstWrite = (nextBurstWrite + 1) % BURST_WRITE_SLOTS;
+    burst.mux_channel = mux_channel;
+    burst.address = i2c_addr;
+    burst.registers = 0;
+    burst.outputs = 0;
+    burst.commandStart = commandStart;
+    for (uint8_t registerAddress = firstRegister; registerAddress < firstRegister + length; registerAddress++) {
+        burst.registers |= SHADOW_REGISTER_BIT(registerAddress);
+        if (registerAddress == 0x03) {
+            burst.outputs |= 0b01; // PWM0
+        } else if (registerAddress == 0x05) {
+            burst.outputs |= 0b10; // PWM1
+        }
+    }
+    I2C_EnqueueWaiting(I2C_BUS_WIRE, i2c_addr, data, 1 + length, 0, onBurstWritten, &burst);
+ }
+
+ // Stages a register write in the shadow, addresses and channels outside it are written straight away
+ static void stageRegister(uint8_t mux_channel, uint8_t i2c_addr, uint8_t registerAddress, uint8_t value) {
+    if (!shadowCovers(mux_channel, i2c_addr, registerAddress)) {
+        I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel);
+        I2C_WR(i2c_addr, registerAddress, value);
+        return;
+    }
+    if (!shadowStage(mux_channel, i2c_addr, registerAddress, value) &&
+        (registerAddress == 0x03 || registerAddress == 0x05) && !I2C_IsDryRun(I2C_BUS_WIRE)) {
+        // The driver already runs at this duty cycle, so the command takes effect now.
+        // The latency filter is left alone, it models writes that go out.
+        pwmWriteTimes[mux_channel][i2c_addr - SHADOW_ADDRESS_BASE][(registerAddress == 0x03) ? 0 : 1] = micros();
+    }
+ }
+
+ // Queues the staged registers of a driver, one auto-increment burst per run. The multiplexer is only
+ // switched when something has to be written. Runs carrying a PWM register record when they land,
+ // runs that fail are forgotten by the shadow.
+ static uint8_t flushDriver(uint8_t mux_channel, uint8_t i2c_addr, uint32_t commandStart, uint8_t registerMask = 0xFF) {
+    ShadowRun runs[SHADOW_MAX_RUNS];
+    uint8_t count = shadowTakeRuns(mux_channel, i2c_addr, runs, registerMask);
+    if (count == 0) {
+        return 0;
+    }
+    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
 
+    for (uint8_t r = 0; r < count; r++) {
+        queueBurst(mux_channel, i2c_addr, runs[r].firstRegister, runs[r].data, runs[r].length, commandStart);
+    }
+    return count;
+ }
+
+ // Records a multicast write in the shadow of every driver it reached
+ static void shadowMulticast(uint8_t channelMask, uint8_t i2c_addr, uint8_t registerAddress, uint8_t value) {
+    for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+        if (channelMask & (1 << mux_channel)) {
+            shadowSet(mux_channel, i2c_addr, registerAddress, value);
+        }
+    }
+ }
+
+
+ // Example register addresses and default values (replace with your actual values)
+ static const uint8_t initRegisters[] = {0x02, 0x03, 0x04, 0x07}; // register addresses
+ static const uint8_t initValues[]    = {0x00, 0x80, 0x00, 0x55}; // Sets the Prescalers to maximum frequency((1+DATA)/160=1/6.35ms the pwm0 needs determining for speed at 50%. 0X07 is the driver, wants to be all inactive.
+
+ static uint32_t lastStopLatency = 0;
 
- 
 
  void motorDriverInit(uint8_t mux_channel,uint8_t i2c_addr) {
 
-    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
-    
-    // Example register addresses and default values (replace with your actual values)
-    const uint8_t registers[] = {0x02, 0x03, 0x04, 0x07}; // register addresses
-    const uint8_t values[]    = {0x00, 0x80, 0x00, 0x55}; // Sets the Prescalers to maximum frequency((1+DATA)/160=1/6.35ms the pwm0 needs determining for speed at 50%. 0X07 is the driver, wants to be all inactive.
+    // The driver may have been reset, so nothing it held before is trusted
+    shadowInvalidate(1 << mux_channel, i2c_addr);
 
-    for (uint8_t i = 0; i < sizeof(registers); i++) {
-        I2C_WR(i2c_addr, registers[i], values[i]);
-        delay(2); // Small delay for I2C stability
+    // Queued writes go out back to back in order, no settling delay is needed between them
+    for (uint8_t i = 0; i < sizeof(initRegisters); i++) {
+        stageRegister(mux_channel, i2c_addr, initRegisters[i], initValues[i]);
     }
+    flushDriver(mux_channel, i2c_addr, micros());
+}
+
+
+I2C_Status motorDriverInitAll(uint8_t channelMask, uint8_t i2c_addr) {
+
+    I2C_SelectChannelMask(I2C_MUX_ADDRESS, channelMask); // Every driver in the mask receives each write
+    shadowInvalidate(channelMask, i2c_addr);
+
+    // Each write is waited for rather than followed by a settling delay
+    for (uint8_t i = 0; i < sizeof(initRegisters); i++) {
+        const uint8_t data[] = {initRegisters[i], initValues[i]};
+        I2C_Status status = I2C_Transfer(I2C_BUS_WIRE, i2c_addr, data, sizeof(data), nullptr, 0);
+        if (status != I2C_OK) {
+            return status;
+        }
+        shadowMulticast(channelMask, i2c_addr, initRegisters[i], initValues[i]);
+    }
+    return I2C_OK;
 }
 
 
 void motorDriverRegControl(uint8_t mux_channel,uint8_t i2c_addr, bool enable) {
 
-    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
-    
+    uint32_t commandStart = micros();
+
     // Enable or disable the motor driver by writing to the corresponding register
     if (enable) {
-        I2C_WR(i2c_addr, 0X08, 0X15); // 0x15 is the value to enable the motor driver and the set up the adc
-        I2C_WR(i2c_addr, 0X08, 0X05); // 0x05 is the value to enable the motor driver and the adc
+        stageRegister(mux_channel, i2c_addr, 0X08, 0X15); // 0x15 is the value to enable the motor driver and the set up the adc
+        flushDriver(mux_channel, i2c_addr, commandStart); // both values have to reach the driver in turn
+        stageRegister(mux_channel, i2c_addr, 0X08, 0X05); // 0x05 is the value to enable the motor driver and the adc
     } else {
-        I2C_WR(i2c_addr, 0X08, 0X00); // 0x00 is the value to disable the motor driver reg and adc.
+        stageRegister(mux_channel, i2c_addr, 0X08, 0X00); // 0x00 is the value to disable the motor driver reg and adc.
     }
+    flushDriver(mux_channel, i2c_addr, commandStart);
 }
 
 void variableMotionControl(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speed, bool direction) {
+    uint32_t commandStart = micros();
+    stageVariableMotion(mux_channel, i2c_addr, speed, direction);
+    flushDriver(mux_channel, i2c_addr, commandStart);
+}
 
-    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
-    
-    // Set the speed and direction for the motor
-    I2C_WR(i2c_addr, 0x05, 255- speed); // Write speed to register 0x05, this sets PWM1 in the chip to a certain duty cycle.
+void stageVariableMotion(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speed, bool direction) {
+    // Set the speed and direction for the motor, only registers that change are written
+    stageRegister(mux_channel, i2c_addr, 0x05, 255- speed); // Write speed to register 0x05, this sets PWM1 in the chip to a certain duty cycle.
     
     if (direction) {
-        I2C_WR(i2c_addr, 0x07, 0xC4); // Set direction to forward (1)
+        stageRegister(mux_channel, i2c_addr, 0x07, 0xC4); // Set direction to forward (1)
     } else {
-        I2C_WR(i2c_addr, 0x07, 0xD1); // Set direction to reverse (0)
+        stageRegister(mux_channel, i2c_addr, 0x07, 0xD1); // Set direction to reverse (0)
     }
-
 }
 
 void setMotionControl(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speedOne, uint8_t speedTwo) {
+    uint32_t commandStart = micros();
+    stageMotionControl(mux_channel, i2c_addr, speedOne, speedTwo);
+    flushDriver(mux_channel, i2c_addr, commandStart);
+}
 
-    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
-    
-    // Set the speed for both motors
-    I2C_WR(i2c_addr, 0x03, 255-speedOne); // Write speed to register 0x05 for motor one
-    I2C_WR(i2c_addr, 0x05, 255-speedTwo); // Write speed to register 0x06 for motor two
+void stageMotionControl(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speedOne, uint8_t speedTwo) {
+    // Set the speed for both motors, a change to both goes out as one burst through 0x04
+    stageRegister(mux_channel, i2c_addr, 0x03, 255-speedOne); // Write speed to register 0x03 for motor one
+    stageRegister(mux_channel, i2c_addr, 0x05, 255-speedTwo); // Write speed to register 0x05 for motor two
 }
 
 
 void defaultMotionControl(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speedLevel, bool direction) {
-    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
+    uint32_t commandStart = micros();
+    stageDefaultMotion(mux_channel, i2c_addr, speedLevel, direction);
+    flushDriver(mux_channel, i2c_addr, commandStart);
+}
 
+void stageDefaultMotion(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speedLevel, bool direction) {
     // Set speed bits (MSBs)
     uint8_t speedBits = 0;
     if (speedLevel == 3) {
@@ -107,7 +271,7 @@ void defaultMotionControl(uint8_t mux_channel, uint8_t i2c_addr, uint8_t speedLe
     uint8_t regValue = speedBits | (directionCode & 0x3F);
 
     // Write the combined value to the register (e.g., 0x07)
-    I2C_WR(i2c_addr, 0x07, regValue);
+    stageRegister(mux_channel, i2c_addr, 0x07, regValue);
 }
 
 
@@ -115,32 +279,225 @@ void motorDriverStop(uint8_t mux_channel, uint8_t i2c_addr) {
 
     I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
     
-    // Stop the motor by setting speed to 0
-    I2C_WR(i2c_addr, 0x07, 0x55); // Write 0 to register 0x05 to stop the motor
+    // Stop the motor by setting speed to 0. Stops always go out, whatever the shadow holds.
+    const uint8_t stopValue = 0x55;
+    if (shadowCovers(mux_channel, i2c_addr, 0x07)) {
+        shadowSet(mux_channel, i2c_addr, 0x07, stopValue);
+        queueBurst(mux_channel, i2c_addr, 0x07, &stopValue, 1, micros()); // forgotten again if it fails
+    } else {
+        I2C_WR(i2c_addr, 0x07, stopValue); // Write 0 to register 0x05 to stop the motor
+    }
     
 }
 
+void stageMotorStop(uint8_t mux_channel, uint8_t i2c_addr) {
+    // All outputs off. As with motorDriverStop(), the stop goes out whatever the shadow holds.
+    if (shadowCovers(mux_channel, i2c_addr, 0x07)) {
+        shadowStage(mux_channel, i2c_addr, 0x07, 0x55, true);
+    } else {
+        stageRegister(mux_channel, i2c_addr, 0x07, 0x55);
+    }
+}
+
+void stageOutputSpeed(uint8_t mux_channel, uint8_t i2c_addr, uint8_t output, uint8_t speed) {
+    stageRegister(mux_channel, i2c_addr, (output == 0) ? 0x03 : 0x05, 255 - speed); // PWM0 or PWM1
+}
 
 
-uint8_t readLimitTriggers(uint8_t mux_channel, uint8_t i2c_addr) {
+uint8_t motorDriverFlush(uint8_t mux_channel, uint8_t i2c_addr, uint32_t commandStart, uint8_t registerMask) {
+    return flushDriver(mux_channel, i2c_addr, commandStart, registerMask);
+}
+
+
+uint8_t takeMotorBurstFailures(uint8_t mux_channel) {
+    if (mux_channel >= MOTOR_DRIVER_CHANNEL_COUNT) {
+        return 0;
+    }
+    __disable_irq();
+    uint8_t failed = failedBursts[mux_channel];
+    failedBursts[mux_channel] = 0;
+    __enable_irq();
+    return failed;
+}
+
+
+I2C_Status motorDriverMulticastWrite(uint8_t channelMask, uint8_t i2c_addr, uint8_t registerAddress, uint8_t value) {
+    uint32_t commandStart = micros();
+
+    I2C_SelectChannelMask(I2C_MUX_ADDRESS, channelMask); // Open every channel in the mask
+
+    // One write reaches every selected driver. Multicasts are used for stops and synchronous updates,
+    // so wait for the write to land, retrying on bus errors.
+    const uint8_t data[] = {registerAddress, value};
+    I2C_Status status = I2C_Transfer(I2C_BUS_WIRE, i2c_addr, data, sizeof(data), nullptr, 0);
+    if (status != I2C_OK) {
+        // Some drivers may have taken the write, none can be trusted to hold what was there before
+        for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+            if ((channelMask & (1 << mux_channel)) && shadowCovers(mux_channel, i2c_addr, registerAddress)) {
+                shadowWriteFailed(mux_channel, i2c_addr, SHADOW_REGISTER_BIT(registerAddress));
+            }
+        }
+        return status;
+    }
+    shadowMulticast(channelMask, i2c_addr, registerAddress, value);
+
+    // Keep the actuation times of the PWM outputs up to date
+    if (registerAddress == 0x03 || registerAddress == 0x05) {
+        uint8_t output = (registerAddress == 0x03) ? 0 : 1;
+        for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+            if (channelMask & (1 << mux_channel)) {
+                recordPWMWrite(mux_channel, i2c_addr, output, commandStart);
+            }
+        }
+    }
+    return I2C_OK;
+}
+
+
+uint32_t motorDriverStopAll(uint8_t i2c_addr) {
+    uint32_t stopRequest = micros();
+
+    // Two bus transactions: the mux control byte and a single LS register write to all eight drivers
+    if (motorDriverMulticastWrite(I2C_MUX_ALL_CHANNELS, i2c_addr, 0x07, 0x55) != I2C_OK) {
+        Serial.println("Error: Emergency stop write failed.");
+    }
+
+    lastStopLatency = micros() - stopRequest;
+    return lastStopLatency;
+}
+
+
+uint32_t getMotorStopLatency() {
+    return lastStopLatency;
+}
+
+
+uint8_t readLimitTriggers(uint8_t mux_channel, uint8_t i2c_addr, I2C_Status* status) {
 
     I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel); // Select the appropriate channel on the I2C multiplexer
     
     // Read the limit triggers from the motor driver
-    uint8_t limitTriggers = (0b00001111 & (I2C_RD(i2c_addr, 0x00))); // Read from register 0x0A (example register for limit triggers)
-    
-    return limitTriggers; // Return the read value
+    uint8_t input = 0;
+    I2C_Status result = I2C_ReadRegister(I2C_BUS_WIRE, i2c_addr, 0x00, input); // INPUT0 holds the limit switches
+    if (status) *status = result;
+
+    return 0b00001111 & input; // Return the read value
+}
+
+
+float readCurrentEstimate(uint8_t mux_channel, uint8_t i2c_addr, I2C_Status* status) {
+    I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel);
+
+    // Read the current estimate from the motor driver (upper 5 bits of register 0x01)
+    uint8_t input = 0;
+    I2C_Status result = I2C_ReadRegister(I2C_BUS_WIRE, i2c_addr, 0x01, input);
+    if (status) *status = result;
+
+    return driverCurrentFromCode((input & 0b11111000) >> 3);
+}
+
+
+float driverCurrentFromCode(uint8_t currentCode) {
+    // Scale to max current (0–31 maps to 0–6.1467A)
+    return (currentCode / 31.0f) * 6.1467f;
+}
+
+
+// Both input registers from the bytes of an auto-increment read starting at 0x00
+static void decodeDriverStatus(const uint8_t* data, MotorDriverStatus& status) {
+    status.limitTriggers = data[0] & 0b00001111;
+    status.currentCode = (data[1] & 0b11111000) >> 3;
+}
+
+// Completion callback of a queued status burst, runs in the I2C interrupt
+static void onDriverStatusRead(const I2C_Job& job) {
+    MotorDriverStatus& status = *(MotorDriverStatus*)job.context;
+    status.status = job.status;
+    if (job.state == I2C_JOB_DONE) {
+        decodeDriverStatus(job.rxData, status);
+    }
 }
 
 
-float readCurrentEstimate(uint8_t mux_channel, uint8_t i2c_addr) {
+MotorDriverStatus readDriverStatus(uint8_t mux_channel, uint8_t i2c_addr) {
+    MotorDriverStatus status = {0, 0, I2C_OK};
+
     I2C_SelectChannel(I2C_MUX_ADDRESS, mux_channel);
 
-    // Read the current estimate from the motor driver (upper 4 bits of register 0x01)
-    uint8_t raw = (I2C_RD(i2c_addr, 0x01) & 0b11111000) >> 3;
+    // Setting the auto-increment bit in the register address reads 0x00 then 0x01 in one transaction
+    const uint8_t registerAddress = LP3943_AUTO_INCREMENT | 0x00;
+    uint8_t data[2];
+    status.status = I2C_Transfer(I2C_BUS_WIRE, i2c_addr, &registerAddress, 1, data, sizeof(data));
+    if (status.status == I2C_OK) {
+        decodeDriverStatus(data, status);
+    }
+    return status;
+}
+
+
+uint8_t readAllDriverStatus(uint8_t i2c_addr, MotorDriverStatus statuses[MOTOR_DRIVER_CHANNEL_COUNT]) {
+    const uint8_t registerAddress = LP3943_AUTO_INCREMENT | 0x00;
+
+    // Queue the channel select and burst of every driver back to back, the queue keeps them in order.
+    // Results land through the callback, so tickets recycled by a long queue do not matter.
+    for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+        statuses[mux_channel].status = I2C_ERROR_INVALID;
+        I2C_SelectChannelMask(I2C_MUX_ADDRESS, 1 << mux_channel);
+        I2C_EnqueueWaiting(I2C_BUS_WIRE, i2c_addr, &registerAddress, 1, 2, onDriverStatusRead, &statuses[mux_channel]);
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+
+    uint8_t read = 0;
+    for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+        if (statuses[mux_channel].status == I2C_OK) {
+            read++;
+        }
+    }
+    return read;
+}
+
+
+// Jobs that have finished on the Wire bus so far
+static uint32_t wireJobCount() {
+    I2C_BusStats stats = I2C_GetBusStats(I2C_BUS_WIRE);
+    return stats.jobsCompleted + stats.jobsFailed;
+}
 
-    // Scale to max current (0–15 maps to 0–6.1467A)
-    float current = (raw / 31.0f) * 6.1467f;
+MotorStatusBenchmark benchmarkDriverStatus(uint8_t i2c_addr) {
+    MotorStatusBenchmark result;
+    MotorDriverStatus statuses[MOTOR_DRIVER_CHANNEL_COUNT];
+
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    uint32_t jobs = wireJobCount();
+    uint32_t start = micros();
+    for (uint8_t mux_channel = 0; mux_channel < MOTOR_DRIVER_CHANNEL_COUNT; mux_channel++) {
+        readLimitTriggers(mux_channel, i2c_addr);
+        readCurrentEstimate(mux_channel, i2c_addr);
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    result.separateMicros = micros() - start;
+    result.separateJobs = wireJobCount() - jobs;
+
+    jobs = wireJobCount();
+    start = micros();
+    readAllDriverStatus(i2c_addr, statuses);
+    result.sweepMicros = micros() - start;
+    result.sweepJobs = wireJobCount() - jobs;
+    return result;
+}
 
-    return current;
+
+uint32_t getMotorPWMWriteTime(uint8_t mux_channel, uint8_t i2c_addr, uint8_t output) {
+    if (!timingCovers(mux_channel, i2c_addr) || output >= MOTOR_DRIVER_OUTPUT_COUNT) {
+        return 0;
+    }
+    return pwmWriteTimes[mux_channel][i2c_addr - SHADOW_ADDRESS_BASE][output];
+}
+
+
+uint32_t getMotorCommandLatency(uint8_t mux_channel, uint8_t i2c_addr) {
+    if (!timingCovers(mux_channel, i2c_addr)) {
+        return 0;
+    }
+    return commandLatency[mux_channel][i2c_addr - SHADOW_ADDRESS_BASE];
 }
\ No newline at end of file
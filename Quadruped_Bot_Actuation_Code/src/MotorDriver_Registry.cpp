@@ -0,0 +1,253 @@
+// MotorDriver_Registry.cpp
+// ------------------------
+// Implementation of the LP3943 driver registry.
+// Probes are queued per channel behind a single multiplexer select and their results land through a
+// completion callback, so discovery of all 64 addresses is one pass through the queue.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "MotorDriver_Registry.h"
+#include "MotorDriver_Frame.h"
+
+static uint8_t registeredAddresses[SHADOW_CHANNEL_COUNT]; // bit n set for address SHADOW_ADDRESS_BASE + n
+static Actuator actuators[REGISTRY_MAX_ACTUATORS];
+static uint8_t driverCount = 0;
+static uint8_t actuatorCount = 0;
+
+// Probe results, written from the I2C interrupt
+static volatile uint8_t probeResults[SHADOW_CHANNEL_COUNT];
+
+// Completion callback of a probe, runs in the I2C interrupt. The context carries channel and address index.
+static void onProbed(const I2C_Job& job) {
+    uintptr_t slot = (uintptr_t)job.context;
+    if (job.state == I2C_JOB_DONE) {
+        probeResults[slot / SHADOW_ADDRESS_COUNT] |= 1 << (slot % SHADOW_ADDRESS_COUNT);
+    }
+}
+
+// Channels with a registered driver at address SHADOW_ADDRESS_BASE + index
+static uint8_t channelsAtAddress(uint8_t index) {
+    uint8_t channels = 0;
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        if (registeredAddresses[mux_channel] & (1 << index)) {
+            channels |= 1 << mux_channel;
+        }
+    }
+    return channels;
+}
+
+
+uint8_t buildActuatorMap(const uint8_t addresses[SHADOW_CHANNEL_COUNT], Actuator* map) {
+    uint8_t count = 0;
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (!(addresses[mux_channel] & (1 << index))) {
+                continue;
+            }
+            for (uint8_t output = 0; output < MOTOR_DRIVER_OUTPUT_COUNT; output++) {
+                map[count].mux_channel = mux_channel;
+                map[count].address = SHADOW_ADDRESS_BASE + index;
+                map[count].output = output;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+uint8_t discoverMotorDrivers() {
+    memset((void*)probeResults, 0, sizeof(probeResults));
+
+    const uint8_t probeRegister = 0x00; // addressing a register is enough for the driver to acknowledge
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        I2C_SelectChannelMask(I2C_MUX_ADDRESS, 1 << mux_channel);
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            uintptr_t slot = mux_channel * SHADOW_ADDRESS_COUNT + index;
+            I2C_EnqueueWaiting(I2C_BUS_WIRE, SHADOW_ADDRESS_BASE + index, &probeRegister, 1, 0, onProbed, (void*)slot);
+        }
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+
+    driverCount = 0;
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        registeredAddresses[mux_channel] = probeResults[mux_channel];
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (registeredAddresses[mux_channel] & (1 << index)) {
+                driverCount++;
+            }
+        }
+    }
+    actuatorCount = buildActuatorMap(registeredAddresses, actuators);
+    return driverCount;
+}
+
+uint8_t getRegisteredDriverCount() {
+    return driverCount;
+}
+
+uint8_t getActuatorCount() {
+    return actuatorCount;
+}
+
+bool getActuator(uint8_t index, Actuator& actuator) {
+    if (index >= actuatorCount) {
+        return false;
+    }
+    actuator = actuators[index];
+    return true;
+}
+
+uint8_t getRegisteredAddresses(uint8_t mux_channel) {
+    return (mux_channel < SHADOW_CHANNEL_COUNT) ? registeredAddresses[mux_channel] : 0;
+}
+
+I2C_Status initRegisteredDrivers(uint8_t channelMask) {
+    I2C_Status result = I2C_OK;
+    for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+        // Every channel that has a driver at this address takes the same multicast
+        uint8_t addressChannels = channelsAtAddress(index) & channelMask;
+        if (addressChannels == 0) {
+            continue;
+        }
+        I2C_Status status = motorDriverInitAll(addressChannels, SHADOW_ADDRESS_BASE + index);
+        if (status != I2C_OK) {
+            result = status;
+        }
+    }
+    return result;
+}
+
+uint32_t stopRegisteredDrivers() {
+    uint32_t stopRequest = micros();
+
+    if (driverCount == 0) {
+        // Nothing discovered, every channel at the default address
+        motorDriverStopAll(SHADOW_ADDRESS_BASE);
+        return micros() - stopRequest;
+    }
+    // One multicast per address, to every channel holding a driver there
+    for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+        uint8_t addressChannels = channelsAtAddress(index);
+        if (addressChannels != 0 &&
+            motorDriverMulticastWrite(addressChannels, SHADOW_ADDRESS_BASE + index, 0x07, 0x55) != I2C_OK) {
+            Serial.print("Error: Emergency stop write failed at 0x");
+            Serial.println(SHADOW_ADDRESS_BASE + index, HEX);
+        }
+    }
+    return micros() - stopRequest;
+}
+
+MotorStopBenchmark benchmarkRegisteredStop() {
+    MotorStopBenchmark result;
+
+    // Both legs start from an empty queue and end when the last stop write has landed
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    uint32_t start = micros();
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        uint8_t addresses = (driverCount > 0) ? registeredAddresses[mux_channel] : 0x01;
+        for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+            if (addresses & (1 << index)) {
+                motorDriverStop(mux_channel, SHADOW_ADDRESS_BASE + index);
+            }
+        }
+    }
+    I2C_WaitIdle(I2C_BUS_WIRE);
+    result.sequentialLatency = micros() - start;
+
+    result.multicastLatency = stopRegisteredDrivers();
+    return result;
+}
+
+bool setActuatorSpeed(uint8_t index, uint8_t speed) {
+    if (index >= actuatorCount) {
+        Serial.println("Error: Invalid actuator requested!");
+        return false;
+    }
+    const Actuator& actuator = actuators[index];
+    return motorFrameSetOutput(actuator.mux_channel, actuator.address, actuator.output, speed);
+}
+
+
+// Jobs, multiplexer writes and bits queued on a dry run Wire bus since before
+static void dryRunDelta(const I2C_DryRunStats& before, uint32_t& jobs, uint32_t& switches, uint32_t& bits) {
+    I2C_DryRunStats after = I2C_GetDryRunStats(I2C_BUS_WIRE);
+    jobs = after.jobs - before.jobs;
+    switches = after.muxWrites - before.muxWrites;
+    bits = after.bits - before.bits;
+}
+
+RegistryBenchmark benchmarkRegistryScaling(uint32_t clockHz) {
+    RegistryBenchmark result = {};
+    uint32_t switches;
+    uint32_t bits;
+    uint32_t perDriverBits;
+    uint32_t groupedBits;
+
+    // The real registry is put back afterwards
+    uint8_t savedAddresses[SHADOW_CHANNEL_COUNT];
+    memcpy(savedAddresses, registeredAddresses, sizeof(savedAddresses));
+    if (motorFrameIsOpen()) {
+        motorFrameAbort();
+    }
+    I2C_SetDryRun(I2C_BUS_WIRE, true);
+
+    memset(registeredAddresses, 0xFF, sizeof(registeredAddresses));
+    uint32_t start = micros();
+    actuatorCount = buildActuatorMap(registeredAddresses, actuators);
+    result.mapMicros = micros() - start;
+    driverCount = actuatorCount / MOTOR_DRIVER_OUTPUT_COUNT;
+    result.drivers = driverCount;
+    result.actuators = actuatorCount;
+
+    // Initialisation: each driver on its own in address-major order, as hand-written calls scale up,
+    // against one multicast per address
+    shadowInvalidateAll();
+    I2C_DryRunStats before = I2C_GetDryRunStats(I2C_BUS_WIRE);
+    for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+        for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+            motorDriverInit(mux_channel, SHADOW_ADDRESS_BASE + index);
+        }
+    }
+    dryRunDelta(before, result.perDriverInitTransactions, switches, bits);
+
+    before = I2C_GetDryRunStats(I2C_BUS_WIRE);
+    initRegisteredDrivers();
+    dryRunDelta(before, result.groupedInitTransactions, switches, bits);
+
+    // A frame setting both outputs of every driver, new speeds each time so nothing is elided.
+    // One driver at a time in address-major order, through the direct motion command.
+    before = I2C_GetDryRunStats(I2C_BUS_WIRE);
+    for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+        for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+            setMotionControl(mux_channel, SHADOW_ADDRESS_BASE + index, 100, 150);
+        }
+    }
+    dryRunDelta(before, result.perDriverFrameTransactions, result.perDriverFrameSwitches, perDriverBits);
+
+    // Grouped: every actuator through the registry into one committed frame
+    before = I2C_GetDryRunStats(I2C_BUS_WIRE);
+    for (uint8_t index = 0; index < actuatorCount; index++) {
+        setActuatorSpeed(index, 120 + 50 * actuators[index].output);
+    }
+    motorFrameCommit(true);
+    dryRunDelta(before, result.groupedFrameTransactions, result.groupedFrameSwitches, groupedBits);
+
+    if (clockHz > 0) {
+        result.perDriverFrameMicros = (uint32_t)((uint64_t)perDriverBits * 1000000UL / clockHz);
+        result.groupedFrameMicros = (uint32_t)((uint64_t)groupedBits * 1000000UL / clockHz);
+    }
+
+    // Nothing the simulation left in the shadow or the multiplexer state is true of the hardware
+    I2C_SetDryRun(I2C_BUS_WIRE, false);
+    shadowInvalidateAll();
+    I2C_MuxInvalidate(I2C_MUX_ADDRESS);
+    memcpy(registeredAddresses, savedAddresses, sizeof(registeredAddresses));
+    actuatorCount = buildActuatorMap(registeredAddresses, actuators);
+    driverCount = actuatorCount / MOTOR_DRIVER_OUTPUT_COUNT;
+    return result;
+}
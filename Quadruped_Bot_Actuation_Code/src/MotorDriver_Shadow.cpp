@@ -0,0 +1,226 @@
+// MotorDriver_Shadow.cpp
+// ----------------------
+// Implementation of the LP3943 shadow registers.
+// Each driver has its register values and two bit masks, one for the registers whose value is known
+// and one for the staged registers that still have to be written.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "MotorDriver_Shadow.h"
+#include "I2C_Queue.h" // Dry run
+
+struct ShadowDriver {
+    uint8_t values[SHADOW_REGISTER_COUNT];
+    uint8_t known;  // bit n set when register SHADOW_FIRST_REGISTER + n is known
+    uint8_t dirty;  // bit n set when register SHADOW_FIRST_REGISTER + n is staged but not written
+    volatile uint8_t lost; // registers whose write failed, set from the I2C interrupt
+    uint8_t commanded[SHADOW_REGISTER_COUNT]; // last value written, kept across invalidation
+    uint8_t commandedMask;
+};
+
+static ShadowDriver shadowDrivers[SHADOW_CHANNEL_COUNT][SHADOW_ADDRESS_COUNT];
+static ShadowStats shadowStats;
+
+
+// Forgets the registers whose writes failed since the last call. The interrupt only ever sets bits
+// in lost, so they are folded into known with interrupts masked.
+static void applyLost(ShadowDriver& driver) {
+    if (driver.lost == 0) {
+        return;
+    }
+    __disable_irq();
+    driver.known &= ~driver.lost;
+    driver.lost = 0;
+    __enable_irq();
+}
+
+
+// Keeps a written value as the commanded state, unless the write was simulated
+static void recordCommanded(ShadowDriver& driver, uint8_t index, uint8_t value) {
+    if (I2C_IsDryRun(I2C_BUS_WIRE)) {
+        return;
+    }
+    driver.commanded[index] = value;
+    driver.commandedMask |= 1 << index;
+}
+
+
+bool shadowCovers(uint8_t mux_channel, uint8_t address, uint8_t registerAddress) {
+    return mux_channel < SHADOW_CHANNEL_COUNT &&
+           address >= SHADOW_ADDRESS_BASE && address < SHADOW_ADDRESS_BASE + SHADOW_ADDRESS_COUNT &&
+           registerAddress >= SHADOW_FIRST_REGISTER && registerAddress < SHADOW_FIRST_REGISTER + SHADOW_REGISTER_COUNT;
+}
+
+bool shadowStage(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t value, bool force) {
+    if (!shadowCovers(mux_channel, address, registerAddress)) {
+        return true;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    applyLost(driver);
+    uint8_t index = registerAddress - SHADOW_FIRST_REGISTER;
+    uint8_t bit = 1 << index;
+
+    if (!force && (driver.known & bit) && !(driver.dirty & bit) && driver.values[index] == value) {
+        shadowStats.hits++;
+        return false;
+    }
+    // Staging the same register twice before a flush only writes the last value
+    if (!(driver.dirty & bit)) {
+        shadowStats.misses++;
+    }
+    driver.values[index] = value;
+    driver.dirty |= bit;
+    return true;
+}
+
+uint8_t shadowTakeRuns(uint8_t mux_channel, uint8_t address, ShadowRun runs[SHADOW_MAX_RUNS], uint8_t registerMask) {
+    if (mux_channel >= SHADOW_CHANNEL_COUNT || address < SHADOW_ADDRESS_BASE ||
+        address >= SHADOW_ADDRESS_BASE + SHADOW_ADDRESS_COUNT) {
+        return 0;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    applyLost(driver);
+    uint8_t count = 0;
+    uint8_t index = 0;
+
+    // Dirty registers outside the mask are never bridged, that would write their new value
+    while ((driver.dirty & registerMask) != 0 && index < SHADOW_REGISTER_COUNT) {
+        if (!(driver.dirty & registerMask & (1 << index))) {
+            index++;
+            continue;
+        }
+        ShadowRun& run = runs[count++];
+        run.firstRegister = SHADOW_FIRST_REGISTER + index;
+        run.length = 0;
+
+        // Extend the run over dirty registers, and over short gaps of known ones when another dirty
+        // register follows the gap
+        while (index < SHADOW_REGISTER_COUNT) {
+            uint8_t bit = 1 << index;
+            if (driver.dirty & registerMask & bit) {
+                run.data[run.length++] = driver.values[index];
+                recordCommanded(driver, index, driver.values[index]);
+                driver.dirty &= ~bit;
+                driver.known |= bit;
+                index++;
+                continue;
+            }
+            uint8_t gap = 0;
+            while (index + gap < SHADOW_REGISTER_COUNT && gap <= SHADOW_BRIDGE_LIMIT &&
+                   (driver.known & (1 << (index + gap))) && !(driver.dirty & (1 << (index + gap)))) {
+                gap++;
+            }
+            if (gap == 0 || gap > SHADOW_BRIDGE_LIMIT || index + gap >= SHADOW_REGISTER_COUNT ||
+                !(driver.dirty & registerMask & (1 << (index + gap)))) {
+                break;
+            }
+            for (uint8_t n = 0; n < gap; n++) {
+                run.data[run.length++] = driver.values[index++];
+            }
+            shadowStats.bridged += gap;
+        }
+        shadowStats.transactions++;
+    }
+    return count;
+}
+
+bool shadowTakeRegister(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t& value) {
+    if (!shadowCovers(mux_channel, address, registerAddress)) {
+        return false;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    uint8_t index = registerAddress - SHADOW_FIRST_REGISTER;
+    uint8_t bit = 1 << index;
+    if (!(driver.dirty & bit)) {
+        return false;
+    }
+    value = driver.values[index];
+    recordCommanded(driver, index, value);
+    driver.dirty &= ~bit;
+    driver.known |= bit;
+    return true;
+}
+
+bool shadowGet(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t& value) {
+    if (!shadowCovers(mux_channel, address, registerAddress)) {
+        return false;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    applyLost(driver);
+    uint8_t bit = 1 << (registerAddress - SHADOW_FIRST_REGISTER);
+    if (!(driver.known & bit) || (driver.dirty & bit)) {
+        return false;
+    }
+    value = driver.values[registerAddress - SHADOW_FIRST_REGISTER];
+    return true;
+}
+
+void shadowSet(uint8_t mux_channel, uint8_t address, uint8_t registerAddress, uint8_t value) {
+    if (!shadowCovers(mux_channel, address, registerAddress)) {
+        return;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    uint8_t index = registerAddress - SHADOW_FIRST_REGISTER;
+    driver.values[index] = value;
+    recordCommanded(driver, index, value);
+    driver.known |= 1 << index;
+    driver.dirty &= ~(1 << index);
+}
+
+void shadowWriteFailed(uint8_t mux_channel, uint8_t address, uint8_t registerMask) {
+    if (!shadowCovers(mux_channel, address, SHADOW_FIRST_REGISTER)) {
+        return;
+    }
+    shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE].lost |= registerMask;
+}
+
+void shadowDiscard(uint8_t mux_channel, uint8_t address) {
+    if (!shadowCovers(mux_channel, address, SHADOW_FIRST_REGISTER)) {
+        return;
+    }
+    ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    driver.known &= ~driver.dirty;
+    driver.dirty = 0;
+}
+
+uint8_t shadowGetCommanded(uint8_t mux_channel, uint8_t address, uint8_t values[SHADOW_REGISTER_COUNT]) {
+    if (!shadowCovers(mux_channel, address, SHADOW_FIRST_REGISTER)) {
+        return 0;
+    }
+    const ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+    memcpy(values, driver.commanded, SHADOW_REGISTER_COUNT);
+    return driver.commandedMask;
+}
+
+void shadowInvalidate(uint8_t channelMask, uint8_t address) {
+    if (address < SHADOW_ADDRESS_BASE || address >= SHADOW_ADDRESS_BASE + SHADOW_ADDRESS_COUNT) {
+        return;
+    }
+    for (uint8_t mux_channel = 0; mux_channel < SHADOW_CHANNEL_COUNT; mux_channel++) {
+        if (channelMask & (1 << mux_channel)) {
+            ShadowDriver& driver = shadowDrivers[mux_channel][address - SHADOW_ADDRESS_BASE];
+            driver.known = 0;
+            driver.dirty = 0;
+            driver.lost = 0;
+        }
+    }
+}
+
+void shadowInvalidateAll() {
+    for (uint8_t index = 0; index < SHADOW_ADDRESS_COUNT; index++) {
+        shadowInvalidate(0xFF, SHADOW_ADDRESS_BASE + index);
+    }
+}
+
+ShadowStats getShadowStats() {
+    return shadowStats;
+}
+
+void resetShadowStats() {
+    memset(&shadowStats, 0, sizeof(shadowStats));
+}
@@ -0,0 +1,189 @@
+// NCDR_Acquisition.cpp
+// --------------------
+// Implementation of background acquisition of the NCDR encoders.
+// The sweep runs as a small state machine: a sweep timer starts it, a one-shot gap timer paces the
+// datasheet delays and an EventResponder is called when each DMA byte transfer completes.
+// None of the steps busy-wait, so the sweep costs only a few short interrupts per channel.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "PinAssignments.h"
+#include "NCDR_Acquisition.h"
+#include "SPI_MUX.h" // Fast multiplexer functions
+#include <EventResponder.h>
+
+// Steps of reading one channel
+enum AcquisitionPhase : uint8_t {
+    PHASE_HIGH_BYTE, // waiting out CS setup, then transferring the first byte
+    PHASE_LOW_BYTE,  // waiting out the byte gap, then transferring the second byte
+    PHASE_HOLD       // waiting out the CS hold, then releasing the channel
+};
+
+static IntervalTimer sweepTimer; // starts a sweep every period
+static IntervalTimer gapTimer;   // one-shot timer for the datasheet delays
+static EventResponder transferDone; // called when a DMA byte transfer completes
+
+static EncoderSnapshot snapshots[2]; // double buffer, one published and one being filled
+static volatile uint8_t publishedIndex = 0;
+static volatile uint32_t publishedSequence = 0;
+
+static volatile bool running = false;
+static volatile bool sweepInProgress = false;
+static volatile uint32_t overruns = 0;
+
+static uint8_t sweepIndex = 0;   // position in the sweep order
+static uint8_t sweepChannel = 0; // channel being read
+static uint8_t fillIndex = 1;
+static AcquisitionPhase phase = PHASE_HIGH_BYTE;
+static uint8_t txByte = 0x00;  // dummy byte clocked out to read the position
+static uint8_t rxBytes[2];     // position word received from the encoder
+static uint32_t sequenceCounter = 0;
+
+static void onGapElapsed();
+
+// Waits the given number of microseconds before moving on to the next step
+static void armGap(uint32_t delayMicros) {
+    gapTimer.begin(onGapElapsed, delayMicros);
+}
+
+static void selectChannel() {
+    sweepChannel = getEncoderSweepOrder()[sweepIndex];
+    ACTIVATE_MUX_FAST(sweepChannel);
+    phase = PHASE_HIGH_BYTE;
+    armGap(NCDR_CS_SETUP_US);
+}
+
+static void finishSweep() {
+    SPI.endTransaction();
+
+    EncoderSnapshot& snapshot = snapshots[fillIndex];
+    snapshot.sweepDuration = micros() - snapshot.sweepStart;
+    snapshot.sequence = ++sequenceCounter;
+
+    // Publish the filled buffer, readers check the sequence to detect a swap during their copy
+    publishedIndex = fillIndex;
+    publishedSequence = snapshot.sequence;
+    sweepInProgress = false;
+}
+
+static void onGapElapsed() {
+    gapTimer.end(); // one-shot
+
+    EncoderSnapshot& snapshot = snapshots[fillIndex];
+
+    if (phase == PHASE_HIGH_BYTE) {
+        snapshot.samples[sweepChannel].timestamp = micros();
+        SPI.transfer(&txByte, &rxBytes[0], 1, transferDone);
+    } else if (phase == PHASE_LOW_BYTE) {
+        SPI.transfer(&txByte, &rxBytes[1], 1, transferDone);
+    } else {
+        DEACTIVATE_MUX_FAST();
+
+        // Decode the position and verify the check bits
+        uint16_t position = ((uint16_t)rxBytes[0] << 8) | rxBytes[1];
+        decodeEncoderSample(sweepChannel, position, snapshot.samples[sweepChannel]);
+
+        if (++sweepIndex < NCDR_CHANNEL_COUNT) {
+            selectChannel();
+        } else {
+            finishSweep();
+        }
+    }
+}
+
+static void onTransferDone(EventResponderRef event) {
+    if (phase == PHASE_HIGH_BYTE) {
+        phase = PHASE_LOW_BYTE;
+        armGap(NCDR_BYTE_GAP_US);
+    } else {
+        phase = PHASE_HOLD;
+        armGap(NCDR_CS_HOLD_US);
+    }
+}
+
+static void onSweepTimer() {
+    if (sweepInProgress) {
+        overruns++; // previous sweep has not finished, skip this one
+        return;
+    }
+    sweepInProgress = true;
+
+    // Fill the buffer readers are not looking at
+    fillIndex = publishedIndex ^ 1;
+    sweepIndex = 0;
+
+    SPI.beginTransaction(SPISettings(getEncoderSPIClock(), MSBFIRST, SPI_MODE0));
+    snapshots[fillIndex].sweepStart = micros();
+    selectChannel();
+}
+
+
+void startEncoderAcquisition(uint32_t periodMicros) {
+    if (running) {
+        return;
+    }
+
+    uint32_t sweepMicros = ncdrSweepNs(getEncoderSPIClock(), NCDR_CHANNEL_COUNT) / 1000;
+    if (periodMicros <= sweepMicros) {
+        Serial.print("Error: Acquisition period must be longer than one sweep (");
+        Serial.print(sweepMicros);
+        Serial.println(" us).");
+        return;
+    }
+
+    transferDone.attachImmediate(onTransferDone);
+    overruns = 0;
+    running = true;
+    sweepTimer.begin(onSweepTimer, periodMicros);
+}
+
+void stopEncoderAcquisition() {
+    if (!running) {
+        return;
+    }
+    sweepTimer.end();
+
+    // Let the sweep in progress finish so the mux and SPI bus are left released
+    while (sweepInProgress) {
+        yield();
+    }
+    running = false;
+}
+
+bool isEncoderAcquisitionRunning() {
+    return running;
+}
+
+bool getLatestEncoderSnapshot(EncoderSnapshot& snapshot) {
+    // A sweep can only overwrite the buffer being copied after it has been republished,
+    // so a second attempt from the newly published buffer always has a full period to finish.
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        uint32_t sequence = publishedSequence;
+        if (sequence == 0) {
+            return false; // no sweep completed yet
+        }
+        snapshot = snapshots[publishedIndex];
+        if (publishedSequence == sequence && snapshot.sequence == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t getEncoderSnapshotSequence() {
+    return publishedSequence;
+}
+
+uint32_t getEncoderSnapshotAge() {
+    const EncoderSnapshot& snapshot = snapshots[publishedIndex];
+    return micros() - (snapshot.sweepStart + snapshot.sweepDuration);
+}
+
+uint32_t getEncoderAcquisitionOverruns() {
+    return overruns;
+}
@@ -0,0 +1,61 @@
+// NCDR_Angle.cpp
+// --------------
+// Benchmark comparing the float degrees encoder path with the fixed-point angle path.
+// Both paths decode a raw encoder word, apply a zero offset and produce an angle, using the cycle counter
+// to measure the cost per sample.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include <Arduino.h>
+#include "NCDR_Angle.h"
+
+// Results are written here so the compiler cannot drop the work being measured
+static volatile float floatSink;
+static volatile EncoderAngle fixedSink;
+
+// The encoder path as it was: 16-bit offset subtraction with a wrap branch, then a float division
+static float floatPathSample(uint16_t word, uint16_t offset) {
+    uint16_t position = (word >> 2) & 0x0FFF;
+    if (position >= offset) {
+        position -= offset;
+    } else {
+        position = (4096 + position) - offset;
+    }
+    return (position * 360.0) / 4096.0;
+}
+
+// The fixed-point path: the offset is removed with modulo arithmetic on the Q16 angle
+static EncoderAngle fixedPathSample(uint16_t word, uint16_t offset) {
+    return encoderCountsToAngle(((word >> 2) & 0x0FFF) - offset);
+}
+
+AnglePathBenchmark benchmarkAnglePaths(uint32_t samples) {
+    AnglePathBenchmark result = {samples, 0.0f, 0.0f};
+    if (samples == 0) {
+        return result;
+    }
+
+    // Sweep through every position so both sides of the wrap branch are exercised
+    const uint16_t offset = 1234;
+
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t n = 0; n < samples; n++) {
+        floatSink = floatPathSample((uint16_t)(n << 2), offset);
+    }
+    uint32_t floatCycles = ARM_DWT_CYCCNT - start;
+
+    start = ARM_DWT_CYCCNT;
+    for (uint32_t n = 0; n < samples; n++) {
+        fixedSink = fixedPathSample((uint16_t)(n << 2), offset);
+    }
+    uint32_t fixedCycles = ARM_DWT_CYCCNT - start;
+
+    result.floatCyclesPerSample = (float)floatCycles / samples;
+    result.fixedCyclesPerSample = (float)fixedCycles / samples;
+    return result;
+}
@@ -0,0 +1,276 @@
+// NCDR_Estimator.cpp
+// ------------------
+// Implementation of the per-joint alpha-beta-gamma estimator.
+// The unwrapped position is kept as a 32-bit count of Q16 angle steps plus a float fraction of a step,
+// so slow motion is not rounded away and the float part never has to hold a large number.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "NCDR_Estimator.h"
+#include "NCDR_Acquisition.h" // Published sweeps
+
+#define ANGLE_STEPS_PER_TURN 65536.0f
+
+struct EstimatorGains {
+    float alpha;
+    float beta;
+    float gamma;
+};
+
+struct EstimatorState {
+    int32_t position;   // unwrapped position in Q16 angle steps
+    float fraction;     // part of a step on top of position, -0.5 to 0.5
+    float velocity;     // steps per second
+    float acceleration; // steps per second squared
+    uint32_t timestamp; // micros() of the last sample used
+    bool initialised;   // false until the first sample is seen
+};
+
+static EstimatorState estimators[NCDR_CHANNEL_COUNT];
+static EstimatorGains gains[NCDR_CHANNEL_COUNT];
+static bool gainsInitialised = false;
+static uint32_t fedSequence = 0; // sequence of the last published sweep fed to the filters
+
+static const EstimatorGains defaultGains = {
+    JOINT_ESTIMATOR_ALPHA_DEFAULT, JOINT_ESTIMATOR_BETA_DEFAULT, JOINT_ESTIMATOR_GAMMA_DEFAULT
+};
+
+
+// Default gains for every channel the first time an estimator is used
+static void initialiseGains() {
+    if (gainsInitialised) {
+        return;
+    }
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        gains[channel] = defaultGains;
+    }
+    gainsInitialised = true;
+}
+
+// Restarts the filter at the measured angle. Once a filter has run, the unwrapped position is kept
+// continuous by moving to the nearest position matching the angle.
+static void restartEstimator(EstimatorState& state, EncoderAngle angle, uint32_t timestamp) {
+    if (state.initialised) {
+        state.position += angleDifference(angle, (EncoderAngle)state.position);
+    } else {
+        state.position = angle;
+    }
+    state.fraction = 0.0f;
+    state.velocity = 0.0f;
+    state.acceleration = 0.0f;
+    state.timestamp = timestamp;
+    state.initialised = true;
+}
+
+static void estimatorUpdate(EstimatorState& state, const EstimatorGains& gain, EncoderAngle angle, uint32_t timestamp) {
+    uint32_t gap = timestamp - state.timestamp;
+    if (!state.initialised || gap > JOINT_ESTIMATOR_MAX_GAP_US) {
+        restartEstimator(state, angle, timestamp);
+        return;
+    }
+    if (gap == 0) {
+        return; // same sample seen twice
+    }
+
+    float dt = gap * 1e-6f;
+    float invDt = 1.0f / dt;
+
+    // Predict forward by the measured time step
+    float step = state.fraction + (state.velocity + 0.5f * state.acceleration * dt) * dt;
+    int32_t wholeSteps = (int32_t)lroundf(step);
+    int32_t predicted = state.position + wholeSteps;
+    float predictedFraction = step - wholeSteps;
+
+    // Residual between the measurement and the prediction, exact across the wrap
+    float residual = angleDifference(angle, (EncoderAngle)predicted) - predictedFraction;
+
+    // Correct
+    float corrected = predictedFraction + gain.alpha * residual;
+    wholeSteps = (int32_t)lroundf(corrected);
+    state.position = predicted + wholeSteps;
+    state.fraction = corrected - wholeSteps;
+    state.velocity += state.acceleration * dt + gain.beta * residual * invDt;
+    state.acceleration += 2.0f * gain.gamma * residual * invDt * invDt;
+    state.timestamp = timestamp;
+}
+
+static JointState toJointState(const EstimatorState& state) {
+    JointState result;
+    result.position = (state.position + state.fraction) / ANGLE_STEPS_PER_TURN;
+    result.velocity = state.velocity / ANGLE_STEPS_PER_TURN;
+    result.acceleration = state.acceleration / ANGLE_STEPS_PER_TURN;
+    result.timestamp = state.timestamp;
+    result.valid = state.initialised;
+    return result;
+}
+
+void updateJointEstimator(uint8_t channel, const EncoderSample& sample) {
+    if (!sample.valid) {
+        return;
+    }
+    initialiseGains();
+    estimatorUpdate(estimators[channel], gains[channel], sample.angle, sample.timestamp);
+}
+
+void updateJointEstimators(const EncoderSnapshot& snapshot) {
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        updateJointEstimator(channel, snapshot.samples[channel]);
+    }
+}
+
+void serviceJointEstimators() {
+    if (!isEncoderAcquisitionRunning() || getEncoderSnapshotSequence() == fedSequence) {
+        return;
+    }
+    EncoderSnapshot snapshot;
+    if (getLatestEncoderSnapshot(snapshot)) {
+        updateJointEstimators(snapshot);
+        fedSequence = snapshot.sequence;
+    }
+}
+
+JointState getJointState(uint8_t channel) {
+    return toJointState(estimators[channel]);
+}
+
+void resetJointEstimator(uint8_t channel) {
+    estimators[channel].initialised = false;
+}
+
+void setJointEstimatorGains(uint8_t channel, float alpha, float beta, float gamma) {
+    if (alpha <= 0.0f || alpha >= 2.0f || beta <= 0.0f || beta >= 4.0f - 2.0f * alpha ||
+        gamma < 0.0f || gamma >= 4.0f * alpha * beta / (2.0f - alpha)) {
+        Serial.println("Error: Estimator gains outside the stable region.");
+        return;
+    }
+    initialiseGains();
+    gains[channel].alpha = alpha;
+    gains[channel].beta = beta;
+    gains[channel].gamma = gamma;
+    resetJointEstimator(channel);
+}
+
+void replayJointEstimator(const EncoderSample* samples, uint16_t count, JointState* states) {
+    EstimatorState state;
+    state.initialised = false;
+
+    for (uint16_t n = 0; n < count; n++) {
+        if (samples[n].valid) {
+            estimatorUpdate(state, defaultGains, samples[n].angle, samples[n].timestamp);
+        }
+        states[n] = toJointState(state);
+    }
+}
+
+
+// Self test
+// ---------
+
+#define SELF_TEST_SAMPLES 600
+#define SELF_TEST_SETTLED 200     // samples at the end of each stream the errors are taken over
+#define SELF_TEST_PERIOD_US 1000
+#define SELF_TEST_JITTER_US 100   // timestamps wander by up to this either side of the period
+#define SELF_TEST_DROP_EVERY 37   // every Nth sample is recorded with failed check bits
+
+struct SelfTestStream {
+    const char* name;
+    float startPosition; // turns
+    float velocity;      // turns per second
+    float acceleration;  // turns per second squared
+    uint8_t noiseCounts; // measurement noise, in encoder counts either side
+    float positionTolerance;
+    float velocityTolerance;
+};
+
+static const SelfTestStream selfTestStreams[] = {
+    // name                  start  vel    accel  noise  pos tol  vel tol
+    {"constant speed, wrap", 0.90f, 2.0f,  0.0f,  0,     0.0005f, 0.08f},
+    {"reverse across wrap",  0.05f, -1.5f, 0.0f,  0,     0.0005f, 0.08f},
+    {"constant accel",       0.0f,  0.0f,  4.0f,  0,     0.0005f, 0.10f},
+    {"at rest, noisy",       0.25f, 0.0f,  0.0f,  1,     0.0010f, 0.25f},
+};
+
+// Deterministic pseudo-random numbers so every run replays the same stream
+static uint32_t selfTestRandom(uint32_t& seed) {
+    seed = seed * 1664525UL + 1013904223UL;
+    return seed >> 16;
+}
+
+// Records a stream as the encoder would have reported it: quantised to counts, wrapped to one turn
+static void recordSelfTestStream(const SelfTestStream& stream, EncoderSample* samples, float* truePosition, float* trueVelocity) {
+    uint32_t seed = 12345;
+    const uint32_t startTime = 0xFFFF0000UL; // start close to the micros() wrap as well
+    uint32_t elapsed = 0;
+
+    for (uint16_t n = 0; n < SELF_TEST_SAMPLES; n++) {
+        elapsed += SELF_TEST_PERIOD_US - SELF_TEST_JITTER_US + selfTestRandom(seed) % (2 * SELF_TEST_JITTER_US + 1);
+        float t = elapsed * 1e-6f;
+
+        truePosition[n] = stream.startPosition + stream.velocity * t + 0.5f * stream.acceleration * t * t;
+        trueVelocity[n] = stream.velocity + stream.acceleration * t;
+
+        int32_t counts = (int32_t)floorf(truePosition[n] * NCDR_DefaultEncoder::COUNTS_PER_TURN + 0.5f);
+        if (stream.noiseCounts != 0) {
+            counts += (int32_t)(selfTestRandom(seed) % (2 * stream.noiseCounts + 1)) - stream.noiseCounts;
+        }
+
+        samples[n].angle = encoderCountsToAngle((uint16_t)(counts & (NCDR_DefaultEncoder::COUNTS_PER_TURN - 1)));
+        samples[n].timestamp = startTime + elapsed;
+        samples[n].valid = (n % SELF_TEST_DROP_EVERY) != SELF_TEST_DROP_EVERY - 1;
+    }
+}
+
+bool selfTestJointEstimator() {
+    EncoderSample samples[SELF_TEST_SAMPLES];
+    JointState states[SELF_TEST_SAMPLES];
+    float truePosition[SELF_TEST_SAMPLES];
+    float trueVelocity[SELF_TEST_SAMPLES];
+    bool allPassed = true;
+
+    for (uint8_t s = 0; s < sizeof(selfTestStreams) / sizeof(selfTestStreams[0]); s++) {
+        const SelfTestStream& stream = selfTestStreams[s];
+        recordSelfTestStream(stream, samples, truePosition, trueVelocity);
+
+        uint32_t start = ARM_DWT_CYCCNT;
+        replayJointEstimator(samples, SELF_TEST_SAMPLES, states);
+        uint32_t cycles = ARM_DWT_CYCCNT - start;
+
+        // The estimated position keeps the turn the stream started in, so compare against the true
+        // position moved into the same turn at the first sample
+        float turnOffset = roundf(states[0].position - truePosition[0]);
+        float maxPositionError = 0.0f;
+        float maxVelocityError = 0.0f;
+        for (uint16_t n = SELF_TEST_SAMPLES - SELF_TEST_SETTLED; n < SELF_TEST_SAMPLES; n++) {
+            if (!samples[n].valid) {
+                continue; // the estimate still holds the previous sample
+            }
+            float positionError = fabsf(states[n].position - truePosition[n] - turnOffset);
+            float velocityError = fabsf(states[n].velocity - trueVelocity[n]);
+            if (positionError > maxPositionError) {
+                maxPositionError = positionError;
+            }
+            if (velocityError > maxVelocityError) {
+                maxVelocityError = velocityError;
+            }
+        }
+
+        bool passed = maxPositionError <= stream.positionTolerance && maxVelocityError <= stream.velocityTolerance;
+        allPassed = allPassed && passed;
+
+        Serial.print(stream.name);
+        Serial.print(": position error ");
+        Serial.print(maxPositionError, 5);
+        Serial.print(" turns, velocity error ");
+        Serial.print(maxVelocityError, 4);
+        Serial.print(" turns/s, ");
+        Serial.print((float)cycles / SELF_TEST_SAMPLES, 1);
+        Serial.print(" cycles/update, ");
+        Serial.println(passed ? "pass" : "FAIL");
+    }
+    return allPassed;
+}
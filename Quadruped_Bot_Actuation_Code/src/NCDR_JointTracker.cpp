@@ -0,0 +1,111 @@
+// NCDR_JointTracker.cpp
+// ---------------------
+// Implementation of the multi-turn joint position tracker.
+// Each channel keeps a signed 32-bit absolute count. Between turn resyncs the count is advanced by the
+// shortest signed difference between consecutive single-turn positions.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "NCDR_JointTracker.h"
+#include "NCDR_Acquisition.h" // To avoid resyncing while the background sweep owns the bus
+
+struct JointTrackerState {
+    int32_t counts;         // absolute position in encoder counts
+    EncoderAngle lastAngle; // last single-turn angle, offset applied
+    bool initialised;       // false until the first position is seen
+    float unitsPerCount;    // scale used by getJointPosition()
+};
+
+static JointTrackerState trackers[NCDR_CHANNEL_COUNT];
+static bool scalesInitialised = false;
+
+static uint16_t turnSyncInterval = JOINT_TURN_SYNC_INTERVAL_DEFAULT;
+static uint16_t snapshotsSinceSync = 0;
+static uint8_t nextSyncChannel = 0;
+
+
+// Default every joint to degrees of the encoder shaft the first time a tracker is used
+static void initialiseScales() {
+    if (scalesInitialised) {
+        return;
+    }
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        trackers[channel].unitsPerCount = 360.0f / NCDR_COUNTS_PER_TURN;
+    }
+    scalesInitialised = true;
+}
+
+// Number of bits a Q16 angle is shifted down by to give encoder counts
+#define ANGLE_TO_COUNTS_SHIFT (ENCODER_ANGLE_BITS - NCDR_POSITION_BITS)
+
+void updateJointTracker(uint8_t channel, EncoderAngle angle) {
+    JointTrackerState& tracker = trackers[channel];
+
+    if (!tracker.initialised) {
+        // No turns information yet, start within the first turn
+        tracker.counts = angle >> ANGLE_TO_COUNTS_SHIFT;
+        tracker.lastAngle = angle;
+        tracker.initialised = true;
+        return;
+    }
+
+    // Shortest signed difference between the two angles, scaled down to counts
+    tracker.counts += angleDifference(angle, tracker.lastAngle) >> ANGLE_TO_COUNTS_SHIFT;
+    tracker.lastAngle = angle;
+}
+
+void updateJointTrackers(const EncoderSnapshot& snapshot) {
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        if (snapshot.samples[channel].valid) {
+            updateJointTracker(channel, snapshot.samples[channel].angle);
+        }
+    }
+
+    if (turnSyncInterval == 0 || isEncoderAcquisitionRunning()) {
+        return;
+    }
+    if (++snapshotsSinceSync >= turnSyncInterval) {
+        snapshotsSinceSync = 0;
+        syncJointTurns(nextSyncChannel);
+        nextSyncChannel = (nextSyncChannel + 1) % NCDR_CHANNEL_COUNT;
+    }
+}
+
+void syncJointTurns(uint8_t channel) {
+    EncoderAngle rawAngle;
+    int16_t turns;
+    if (!readPositionAndTurns(channel, rawAngle, turns)) {
+        return; // keep unwrapping until the next resync
+    }
+
+    // The zero offset is applied to the raw angle so the count is zero at the calibrated zero
+    JointTrackerState& tracker = trackers[channel];
+    int32_t withinTurn = ((int32_t)rawAngle - getEncoderOffset(channel)) >> ANGLE_TO_COUNTS_SHIFT;
+    tracker.counts = (int32_t)turns * NCDR_COUNTS_PER_TURN + withinTurn;
+    tracker.lastAngle = applyEncoderOffset(channel, rawAngle);
+    tracker.initialised = true;
+}
+
+void setJointTurnSyncInterval(uint16_t snapshots) {
+    turnSyncInterval = snapshots;
+    snapshotsSinceSync = 0;
+}
+
+int32_t getJointCounts(uint8_t channel) {
+    return trackers[channel].counts;
+}
+
+float getJointPosition(uint8_t channel) {
+    initialiseScales();
+    return trackers[channel].counts * trackers[channel].unitsPerCount;
+}
+
+void setJointScale(uint8_t channel, float unitsPerCount) {
+    initialiseScales();
+    trackers[channel].unitsPerCount = unitsPerCount;
+}
@@ -0,0 +1,88 @@
+// NCDR_OffsetStore.cpp
+// --------------------
+// Implementation of the EEPROM store for the encoder zero offsets.
+// EEPROM.put() only rewrites bytes that changed, so saving unchanged offsets costs no flash wear.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include <EEPROM.h>
+#include "EEPROM_Map.h"
+#include "NCDR_OffsetStore.h"
+
+static_assert(sizeof(EncoderOffsetRecord) <= 64, "Encoder offset record outgrew its EEPROM reservation");
+
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+static uint16_t crc16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t recordCrc(const EncoderOffsetRecord& record) {
+    return crc16((const uint8_t*)&record, offsetof(EncoderOffsetRecord, crc));
+}
+
+bool loadEncoderOffsets() {
+    EncoderOffsetRecord record;
+    EEPROM.get(EEPROM_ENCODER_OFFSETS_ADDRESS, record);
+
+    if (record.magic != NCDR_OFFSET_RECORD_MAGIC) {
+        Serial.println("No encoder offsets stored.");
+        return false;
+    }
+    if (record.version != NCDR_OFFSET_RECORD_VERSION || record.channelCount != NCDR_CHANNEL_COUNT) {
+        Serial.print("Error: Stored encoder offsets are version ");
+        Serial.print(record.version);
+        Serial.print(" for ");
+        Serial.print(record.channelCount);
+        Serial.println(" channels, ignoring them.");
+        return false;
+    }
+    if (record.crc != recordCrc(record)) {
+        Serial.println("Error: Stored encoder offsets failed the CRC check, ignoring them.");
+        return false;
+    }
+
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        setEncoderOffset(channel, record.offsets[channel]);
+    }
+    return true;
+}
+
+void saveEncoderOffsets() {
+    EncoderOffsetRecord record;
+    memset(&record, 0, sizeof(record)); // keep the trailing padding in EEPROM deterministic
+
+    record.magic = NCDR_OFFSET_RECORD_MAGIC;
+    record.version = NCDR_OFFSET_RECORD_VERSION;
+    record.channelCount = NCDR_CHANNEL_COUNT;
+    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+        record.offsets[channel] = getEncoderOffset(channel);
+    }
+    record.crc = recordCrc(record);
+
+    EEPROM.put(EEPROM_ENCODER_OFFSETS_ADDRESS, record);
+}
+
+bool calibrateEncoders() {
+    bool allValid = zeroAllEncoders();
+
+    // Only a complete set of offsets is worth keeping across power cycles
+    if (allValid) {
+        saveEncoderOffsets();
+        Serial.println("Encoder offsets calibrated and saved.");
+    } else {
+        Serial.println("Error: Encoder calibration incomplete, offsets not saved.");
+    }
+    return allValid;
+}
@@ -0,0 +1,97 @@
+// NCDR_Prediction.cpp
+// -------------------
+// Implementation of the joint latency compensation.
+// Predictions extrapolate the estimator state with constant acceleration over the time since its sample.
+//
+// Author: Greg Moxon
+// Organisation: Moxon Electronics
+// Created: 2026-10-17
+//
+// This file is part of the Quad_Bot_Code_Actuation project.
+
+
+#include "NCDR_Prediction.h"
+
+// Prediction waiting for its motor command to land
+struct PendingActuation {
+    uint32_t sampleTime;   // timestamp of the encoder sample the prediction was made from
+    uint32_t expectedTime; // when the command was expected to land
+    bool pending;
+};
+
+struct LatencyAccumulator {
+    uint32_t commands;
+    uint32_t minLatency;
+    uint32_t maxLatency;
+    uint64_t latencySum;
+    int64_t landingErrorSum;
+};
+
+static PendingActuation pendingActuations[NCDR_CHANNEL_COUNT];
+static LatencyAccumulator latencies[NCDR_CHANNEL_COUNT];
+
+
+JointState predictJointState(uint8_t joint, uint32_t atTime) {
+    JointState state = getJointState(joint);
+    if (!state.valid) {
+        return state;
+    }
+
+    // Signed, so a time before the sample extrapolates backwards rather than a whole micros() wrap forwards
+    float dt = (int32_t)(atTime - state.timestamp) * 1e-6f;
+    state.position += (state.velocity + 0.5f * state.acceleration * dt) * dt;
+    state.velocity += state.acceleration * dt;
+    state.timestamp = atTime;
+    return state;
+}
+
+JointState predictJointAtActuation(uint8_t joint) {
+    uint32_t expectedTime = micros() + getMotorCommandLatency(JOINT_MOTOR_CHANNEL(joint), JOINT_MOTOR_ADDRESS(joint));
+    JointState state = getJointState(joint);
+
+    PendingActuation& pendingActuation = pendingActuations[joint];
+    pendingActuation.sampleTime = state.timestamp;
+    pendingActuation.expectedTime = expectedTime;
+    pendingActuation.pending = state.valid;
+
+    return predictJointState(joint, expectedTime);
+}
+
+void recordJointActuation(uint8_t joint) {
+    PendingActuation& pendingActuation = pendingActuations[joint];
+    if (!pendingActuation.pending) {
+        return;
+    }
+    pendingActuation.pending = false;
+
+    uint32_t landedTime = getMotorPWMWriteTime(JOINT_MOTOR_CHANNEL(joint), JOINT_MOTOR_ADDRESS(joint), JOINT_MOTOR_OUTPUT(joint));
+    uint32_t latency = landedTime - pendingActuation.sampleTime;
+
+    LatencyAccumulator& accumulator = latencies[joint];
+    if (accumulator.commands == 0 || latency < accumulator.minLatency) {
+        accumulator.minLatency = latency;
+    }
+    if (latency > accumulator.maxLatency) {
+        accumulator.maxLatency = latency;
+    }
+    accumulator.latencySum += latency;
+    accumulator.landingErrorSum += (int32_t)(landedTime - pendingActuation.expectedTime);
+    accumulator.commands++;
+}
+
+JointLatencyStats getJointLatencyStats(uint8_t joint) {
+    const LatencyAccumulator& accumulator = latencies[joint];
+    JointLatencyStats stats = {accumulator.commands, 0, 0, 0, 0};
+    if (accumulator.commands == 0) {
+        return stats;
+    }
+    stats.minLatency = accumulator.minLatency;
+    stats.meanLatency = (uint32_t)(accumulator.latencySum / accumulator.commands);
+    stats.maxLatency = accumulator.maxLatency;
+    stats.meanLandingError = (int32_t)(accumulator.landingErrorSum / (int64_t)accumulator.commands);
+    return stats;
+}
+
+void resetJointLatencyStats() {
+    memset(latencies, 0, sizeof(latencies));
+}
@@ -12,6 +12,7 @@
 
 #include "PinAssignments.h"
 #include "SPI_MUX.h"
+#include "SPI_NCDR_TIMING.h" // Mux settling times shared with the sweep timing model
 
 uint8_t MUX_channel = 0; //SPI multiplexer channel number 0 default
 // put function declarations here:
@@ -60,5 +61,37 @@ void DEACTIVATE_MUX() {
     delayMicroseconds(3); // Small delay for stability
 
     }
-    
-    
\ No newline at end of file
+
+
+void ACTIVATE_MUX_FAST(uint8_t SPI_channel) {
+    SPI_MUX_PRELOAD(SPI_channel);
+    SPI_MUX_LATCH();
+}
+
+void DEACTIVATE_MUX_FAST() {
+    // Disable all multiplexer outputs
+    digitalWriteFast(INHIBIT, HIGH);
+    delayNanoseconds(SPI_MUX_RELEASE_NS);
+}
+
+void SPI_MUX_PRELOAD(uint8_t SPI_channel) {
+    // Channel is masked rather than checked, the sweeps only ever pass 0 to 15
+    MUX_channel = SPI_channel & 0x0F;
+
+    // Set the multiplexer control pins with direct GPIO writes, the outputs do not change until latched
+    digitalWriteFast(CS_1, MUX_channel & 0x01);       // LSB
+    digitalWriteFast(CS_2, (MUX_channel >> 1) & 0x01);
+    digitalWriteFast(CS_3, (MUX_channel >> 2) & 0x01);
+    digitalWriteFast(CS_4, (MUX_channel >> 3) & 0x01); // MSB
+}
+
+void SPI_MUX_LATCH() {
+    // Latch the preloaded channel, the decoder only needs a sub microsecond strobe
+    digitalWriteFast(STROBE, HIGH);
+    delayNanoseconds(SPI_MUX_STROBE_NS);
+    digitalWriteFast(STROBE, LOW);
+
+    // Enable the multiplexer outputs and wait for the decoder to settle
+    digitalWriteFast(INHIBIT, LOW);
+    delayNanoseconds(SPI_MUX_SETTLE_NS);
+}
@@ -15,7 +15,103 @@
 #include "SPI_NCDR_FCT.h"
 #include "SPI_MUX.h" // Include multiplexer functions
 
-static uint16_t offsets[16] = {0}; // Array to store offsets for up to 16 channels
+static EncoderAngle offsets[16] = {0}; // Array to store offsets for up to 16 channels
+static uint32_t checkErrors[16] = {0}; // Responses that failed the check bits, per channel
+static uint32_t encoderSPIClock = NCDR_SPI_CLOCK_DEFAULT; // SPI clock for all encoder transfers
+static uint32_t sweepSequence = 0; // number of sweeps completed by readAllEncoders()
+
+// Sampling order of the sweeps, entries 2n and 2n+1 are the two joints of leg n
+static uint8_t sweepOrder[NCDR_CHANNEL_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+
+bool setEncoderSweepOrder(const uint8_t order[NCDR_CHANNEL_COUNT]) {
+  // The order must contain every channel exactly once
+  uint16_t seen = 0;
+  for (uint8_t i = 0; i < NCDR_CHANNEL_COUNT; i++) {
+    if (order[i] >= NCDR_CHANNEL_COUNT || (seen & (1 << order[i]))) {
+      Serial.println("Error: Encoder sweep order must contain each channel 0 to 15 once");
+      return false;
+    }
+    seen |= (1 << order[i]);
+  }
+  memcpy(sweepOrder, order, sizeof(sweepOrder));
+  return true;
+}
+
+const uint8_t* getEncoderSweepOrder() {
+  return sweepOrder;
+}
+
+// Cycle counter deadline a number of microseconds from now, lets work overlap the datasheet delays
+static inline uint32_t deadlineAfter(uint32_t delayMicros) {
+  return ARM_DWT_CYCCNT + delayMicros * (F_CPU_ACTUAL / 1000000);
+}
+
+static inline void waitForDeadline(uint32_t deadline) {
+  while ((int32_t)(ARM_DWT_CYCCNT - deadline) < 0) {
+    // Wait out the remainder of the delay
+  }
+}
+
+
+void setEncoderSPIClock(uint32_t clockHz) {
+  if (clockHz == 0 || clockHz > 2000000) {
+    Serial.println("Error: Invalid encoder SPI clock! Must be between 1Hz and 2MHz");
+    return;
+  }
+  encoderSPIClock = clockHz;
+}
+
+uint32_t getEncoderSPIClock() {
+  return encoderSPIClock;
+}
+
+// Resolution mask of the model fitted to each channel. The model only changes this constant,
+// so mixed models share one decode path with no branching on model type.
+#define CHANNEL_ANGLE_MASK(channel) NCDR_ChannelEncoder<channel>::type::ANGLE_MASK
+static const EncoderAngle channelAngleMask[NCDR_CHANNEL_COUNT] = {
+  CHANNEL_ANGLE_MASK(0),  CHANNEL_ANGLE_MASK(1),  CHANNEL_ANGLE_MASK(2),  CHANNEL_ANGLE_MASK(3),
+  CHANNEL_ANGLE_MASK(4),  CHANNEL_ANGLE_MASK(5),  CHANNEL_ANGLE_MASK(6),  CHANNEL_ANGLE_MASK(7),
+  CHANNEL_ANGLE_MASK(8),  CHANNEL_ANGLE_MASK(9),  CHANNEL_ANGLE_MASK(10), CHANNEL_ANGLE_MASK(11),
+  CHANNEL_ANGLE_MASK(12), CHANNEL_ANGLE_MASK(13), CHANNEL_ANGLE_MASK(14), CHANNEL_ANGLE_MASK(15)
+};
+
+typedef NCDR_DefaultEncoder::Protocol EncoderProtocol; // protocol shared by every model on the bus
+
+// Decodes a position response into a raw angle, returns false if the check bits do not match
+static inline bool decodeRawAngle(uint8_t channel, uint16_t word, EncoderAngle& angle) {
+  angle = NCDR_AMT22_14Bit::decodeAngle(word) & channelAngleMask[channel];
+  if (!NCDR_DefaultEncoder::checkBitsValid(word)) {
+    checkErrors[channel]++;
+    return false;
+  }
+  return true;
+}
+
+// Subtracts the zero offset of a channel from a raw angle.
+// Both are Q16 fractions of a turn, so the wrap-around is exact modulo arithmetic.
+EncoderAngle applyEncoderOffset(uint8_t channel, EncoderAngle angle) {
+  return angle - offsets[channel];
+}
+
+EncoderAngle getEncoderOffset(uint8_t channel) {
+  return offsets[channel];
+}
+
+void setEncoderOffset(uint8_t channel, EncoderAngle offset) {
+  offsets[channel] = offset;
+}
+
+bool decodeEncoderSample(uint8_t channel, uint16_t word, EncoderSample& sample) {
+  EncoderAngle angle;
+  sample.valid = decodeRawAngle(channel, word, angle);
+  sample.angle = applyEncoderOffset(channel, angle);
+  return sample.valid;
+}
+
+uint32_t getEncoderCheckErrors(uint8_t channel) {
+  return checkErrors[channel];
+}
 
 float readEncoderPosition(uint8_t channel) {
   uint16_t position = 0;
@@ -24,8 +120,8 @@ float readEncoderPosition(uint8_t channel) {
   ACTIVATE_MUX(channel);
   delayMicroseconds(3); // Small delay to establish CS for the encoder
 
-  // Start SPI transaction with SPI Mode 0 and 100kHz clock speed
-  SPI.beginTransaction(SPISettings(100000, MSBFIRST, SPI_MODE0));
+  // Start SPI transaction with SPI Mode 0 at the configured clock speed
+  SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
 
   // Send dummy bytes and read the 16-bit response
   position = SPI.transfer(0x00) << 8; // Send dummy data and receive 8 bits
@@ -40,31 +136,159 @@ float readEncoderPosition(uint8_t channel) {
   // Deactivate the multiplexer
   DEACTIVATE_MUX();
 
-  // Extract the 12-bit position (ignore the first 2 bits and last 2 bits)
-  position = (position >> 2) & 0x0FFF; // Mask to get the 12-bit value
+  // Extract the position and verify the check bits
+  EncoderAngle angle;
+  if (!decodeRawAngle(channel, position, angle)) {
+    return NAN;
+  }
 
-  // Apply the offset
-  if (position >= offsets[channel]) {
-      position -= offsets[channel];
-  } else {
-      position = (4096 + position) - offsets[channel]; // Handle wrap-around
+  // Apply the offset and convert to degrees
+  return angleToDegrees(applyEncoderOffset(channel, angle));
+}
+
+
+EncoderSnapshot readAllEncoders() {
+  EncoderSnapshot snapshot;
+
+  // One transaction covers the whole sweep, the mux rather than the SPI peripheral selects the encoder
+  SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
+  snapshot.sweepStart = micros();
+
+  for (uint8_t i = 0; i < NCDR_CHANNEL_COUNT; i++) {
+    uint8_t channel = sweepOrder[i];
+    ACTIVATE_MUX_FAST(channel);
+    delayMicroseconds(NCDR_CS_SETUP_US); // Establish CS for the encoder
+
+    snapshot.samples[channel].timestamp = micros();
+    uint16_t position = SPI.transfer(0x00) << 8;
+    delayMicroseconds(NCDR_BYTE_GAP_US);
+    position |= SPI.transfer(0x00);
+    delayMicroseconds(NCDR_CS_HOLD_US);
+
+    DEACTIVATE_MUX_FAST();
+
+    decodeEncoderSample(channel, position, snapshot.samples[channel]);
   }
-  float degrees = (position * 360.0) / 4096.0; // Convert to degrees
-  return degrees;
+
+  SPI.endTransaction();
+  snapshot.sweepDuration = micros() - snapshot.sweepStart;
+  snapshot.sequence = ++sweepSequence;
+
+  return snapshot;
+}
+
+
+EncoderSnapshot readAllEncodersPipelined() {
+  EncoderSnapshot snapshot;
+  uint16_t position = 0;
+  uint8_t previous = sweepOrder[0];
+
+  SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
+  snapshot.sweepStart = micros();
+
+  SPI_MUX_PRELOAD(sweepOrder[0]);
+  SPI_MUX_LATCH();
+
+  for (uint8_t i = 0; i < NCDR_CHANNEL_COUNT; i++) {
+    uint8_t channel = sweepOrder[i];
+
+    // Decode the previous channel while the CS setup time of this one runs
+    uint32_t deadline = deadlineAfter(NCDR_CS_SETUP_US);
+    if (i > 0) {
+      decodeEncoderSample(previous, position, snapshot.samples[previous]);
+    }
+    waitForDeadline(deadline);
+
+    snapshot.samples[channel].timestamp = micros();
+    position = SPI.transfer(0x00) << 8;
+
+    // Preload the next channel onto the mux inputs while the byte gap runs
+    deadline = deadlineAfter(NCDR_BYTE_GAP_US);
+    if (i + 1 < NCDR_CHANNEL_COUNT) {
+      SPI_MUX_PRELOAD(sweepOrder[i + 1]);
+    }
+    waitForDeadline(deadline);
+
+    position |= SPI.transfer(0x00);
+    delayMicroseconds(NCDR_CS_HOLD_US);
+
+    // Release this channel and latch the preloaded one straight away
+    DEACTIVATE_MUX_FAST();
+    if (i + 1 < NCDR_CHANNEL_COUNT) {
+      SPI_MUX_LATCH();
+    }
+    previous = channel;
+  }
+  decodeEncoderSample(previous, position, snapshot.samples[previous]);
+
+  SPI.endTransaction();
+  snapshot.sweepDuration = micros() - snapshot.sweepStart;
+  snapshot.sequence = ++sweepSequence;
+
+  return snapshot;
+}
+
+
+uint32_t getEncoderPairSkew(const EncoderSnapshot& snapshot, uint8_t leg) {
+  uint8_t first = sweepOrder[leg * NCDR_JOINTS_PER_LEG];
+  uint8_t second = sweepOrder[leg * NCDR_JOINTS_PER_LEG + 1];
+  return snapshot.samples[second].timestamp - snapshot.samples[first].timestamp;
+}
+
+
+EncoderSweepBenchmark benchmarkEncoderSweep(uint16_t iterations) {
+  EncoderSweepBenchmark result = {};
+  result.iterations = iterations;
+  if (iterations == 0) {
+    return result;
+  }
+
+  uint32_t totalSweep = 0;
+  uint32_t totalSerialSweep = 0;
+
+  for (uint16_t n = 0; n < iterations; n++) {
+    EncoderSnapshot snapshot = readAllEncodersPipelined();
+    totalSweep += snapshot.sweepDuration;
+    if (snapshot.sweepDuration > result.maxSweep) {
+      result.maxSweep = snapshot.sweepDuration;
+    }
+
+    for (uint8_t leg = 0; leg < NCDR_LEG_COUNT; leg++) {
+      uint32_t skew = getEncoderPairSkew(snapshot, leg);
+      if (skew > result.worstPairSkew) {
+        result.worstPairSkew = skew;
+        result.worstPairLeg = leg;
+      }
+    }
+
+    totalSerialSweep += readAllEncoders().sweepDuration;
+  }
+
+  result.meanSweep = totalSweep / iterations;
+  result.meanSerialSweep = totalSerialSweep / iterations;
+  return result;
 }
   
 int16_t readTurns(uint8_t channel) {
-  // Activate the multiplexer for the desired channel
-  ACTIVATE_MUX(channel);
+  EncoderAngle angle;
+  int16_t turns;
+  readPositionAndTurns(channel, angle, turns);
+  return turns;
+}
+
+bool readPositionAndTurns(uint8_t channel, EncoderAngle& angle, int16_t& turns) {
+  // Activate the multiplexer for the desired channel. The fast path keeps this cheap enough
+  // for the joint tracker to resync turns periodically while the robot is moving.
+  ACTIVATE_MUX_FAST(channel);
   delayMicroseconds(3); // Small delay to establish CS for the encoder
 
   // Start SPI transaction
-  SPI.beginTransaction(SPISettings(100000, MSBFIRST, SPI_MODE0));
+  SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
 
-  // Send the command sequence to read turns
-  SPI.transfer(0x00); // First byte
+  // Send the command sequence to read turns, the first two bytes return the position
+  uint16_t rawPosition = SPI.transfer(0x00) << 8; // First byte (receive high byte of position)
   delayMicroseconds(3);
-  SPI.transfer(0xA0); // Second byte
+  rawPosition |= SPI.transfer(EncoderProtocol::TURNS_COMMAND); // Second byte (receive low byte of position)
   delayMicroseconds(40); // Small delay as prescribed by the datasheet
   uint16_t highByte = SPI.transfer(0x00); // Third byte (receive high byte of turns)
   delayMicroseconds(3);
@@ -72,14 +296,20 @@ int16_t readTurns(uint8_t channel) {
   delayMicroseconds(3);
   // End SPI transaction
   SPI.endTransaction();
-  DEACTIVATE_MUX();
+  DEACTIVATE_MUX_FAST();
   
   uint16_t rawTurns = (highByte << 8) | lowByte;
   
- // Right-shift the combined value by 2 bits and mask to extract the middle 12 bits
- int16_t turns = (rawTurns >> 2) & 0x0FFF;
-
-  return turns;
+  // Extract the position, no offset applied
+  bool valid = decodeRawAngle(channel, rawPosition, angle);
+
+  // The turns counter is a signed value filling the data bits
+  turns = NCDR_DefaultEncoder::decodeTurns(rawTurns);
+  if (!NCDR_DefaultEncoder::checkBitsValid(rawTurns)) {
+    checkErrors[channel]++;
+    valid = false;
+  }
+  return valid;
 }
 
 
@@ -97,14 +327,14 @@ void resetEncoder(uint8_t channel) {
     delayMicroseconds(3); // Small delay to establish CS for the encoder
 
     // Start SPI transaction
-    SPI.beginTransaction(SPISettings(100000, MSBFIRST, SPI_MODE0));
+    SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
 
     // Send the first byte (always 0x00)
     SPI.transfer(0x00);
     delayMicroseconds(3); // Small delay as prescribed by the datasheet
 
     // Send the second byte (reboot command 0x60)
-    SPI.transfer(0x60);
+    SPI.transfer(EncoderProtocol::RESET_COMMAND);
     delayMicroseconds(3); // Small delay as prescribed by the datasheet
 
     // End SPI transaction
@@ -114,13 +344,13 @@ void resetEncoder(uint8_t channel) {
     DEACTIVATE_MUX();
     // Read the raw encoder position directly after reset
     offsets[channel] = 0; // Reset the offset to 0 for this channel
-    delay(200); // Wait for the encoder to reboot and stabilize
+    delay(EncoderProtocol::RESET_TIME_MS); // Wait for the encoder to reboot and stabilize
 
 
     ACTIVATE_MUX(channel);
     delayMicroseconds(3);
 
-    SPI.beginTransaction(SPISettings(100000, MSBFIRST, SPI_MODE0));
+    SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
 
     // Send dummy bytes to read the raw position
     uint16_t rawPosition = SPI.transfer(0x00) << 8; // Send dummy data and receive 8 bits
@@ -131,18 +361,60 @@ void resetEncoder(uint8_t channel) {
     SPI.endTransaction();
     DEACTIVATE_MUX();
 
-    // Extract the 12-bit position (ignore the first 2 bits and last 2 bits)
-    rawPosition = (rawPosition >> 2) & 0x0FFF;
+    // Extract the position and verify the check bits
+    EncoderAngle rawAngle;
+    if (!decodeRawAngle(channel, rawPosition, rawAngle)) {
+      Serial.print("Error: Encoder on channel ");
+      Serial.print(channel);
+      Serial.println(" failed the check bits after reboot. Offset left at 0.");
+      return;
+    }
 
 
 
 // Store the raw position as the offset for this channel
-offsets[channel] = rawPosition;
+offsets[channel] = rawAngle;
 
 
 
 Serial.print("Encoder on channel ");
 Serial.print(channel);
 Serial.print(" has been rebooted. Offset set to: ");
-Serial.println(offsets[channel]);
-}
\ No newline at end of file
+Serial.print(angleToDegrees(offsets[channel]), 2);
+Serial.println(" deg");
+}
+
+
+bool zeroAllEncoders() {
+  // Send the reboot command to every channel back to back rather than waiting out each reboot in turn
+  SPI.beginTransaction(SPISettings(encoderSPIClock, MSBFIRST, SPI_MODE0));
+  for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+    ACTIVATE_MUX_FAST(channel);
+    delayMicroseconds(NCDR_CS_SETUP_US);
+    SPI.transfer(0x00);
+    delayMicroseconds(NCDR_BYTE_GAP_US);
+    SPI.transfer(EncoderProtocol::RESET_COMMAND);
+    delayMicroseconds(NCDR_CS_HOLD_US);
+    DEACTIVATE_MUX_FAST();
+
+    offsets[channel] = 0; // Reset the offset so the sweep below returns raw angles
+  }
+  SPI.endTransaction();
+
+  delay(EncoderProtocol::RESET_TIME_MS); // One wait covers every encoder
+
+  // Store the raw angles as the offsets
+  bool allValid = true;
+  EncoderSnapshot snapshot = readAllEncoders();
+  for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+    if (snapshot.samples[channel].valid) {
+      offsets[channel] = snapshot.samples[channel].angle;
+    } else {
+      Serial.print("Error: Encoder on channel ");
+      Serial.print(channel);
+      Serial.println(" failed the check bits after reboot. Offset left at 0.");
+      allValid = false;
+    }
+  }
+  return allValid;
+}
@@ -2,7 +2,9 @@
 // ------------
 // Applies all configuration and numerical commands to initialize and configure the BMS (Battery Management System).
 // This function should be called during setup to ensure the BMS is correctly configured before operation.
-// If configuration is stored in NVM (Non-Volatile Memory), this setup can be commented out on startup.
+// The device first loads its NVM. If that matches the settings nothing is written, otherwise the settings
+// are applied as one transaction: only registers that differ from the device are written,
+// all in one conversion-off window, then verified before conversions are turned back on.
 //
 // Author: Greg Moxon
 // Organisation: Moxon Electronics
@@ -17,125 +19,152 @@
 #include "BMS_CoreCommands.h"
 #include "BMS_SetupCommands.h"
 #include "BMS_NumericalCommands.h"
+#include "BMS_Config.h" // Transactional configuration
+#include "BMS_NVM.h" // Fast boot from NVM
 
 
-// Function to send identity commands to the BMS
-
-void SetUpBMS() {
-	
-
-
-	
-
-    //RWBMSNVM("NVM_2_UL"); // This is the command to commit the DATA from the NVM TO I2C, this should be called on startup.	
-
-    
-
-	// Configure What to read and record.
-	sendBMSConfigCommand("CFG2_ENABLES", "default");
+// BMS configuration applied at startup, in the order it reads best. Change the arguments here.
+static const BmsConfigSetting bmsConfiguration[] = {
+    // Configure What to read and record.
+    {BMS_CFG2_ENABLES, "default", nullptr},
 
     // Configure which cells are enabled for balancing
-    sendBMSConfigCommand("TO_PRDV_BAL_MSK", "default");
+    {BMS_TO_PRDV_BAL_MSK, "default", nullptr},
 
     // Configure which fuses are enabled for reset (controls fuse reset mask)
-    sendBMSConfigCommand("TO_FUSE_RST_MSK", "default");
+    {BMS_TO_FUSE_RST_MSK, "default", nullptr},
 
     // Configure which faults are enabled for nFAULT pin signaling
-    sendBMSConfigCommand("TO_FAULTN_MSK", "default");
+    {BMS_TO_FAULTN_MSK, "default", nullptr},
 
     // Configure current measurement mask (enables/disables current sensing)
-    sendBMSConfigCommand("CURR_MSK", "default");
+    {BMS_CURR_MSK, "default", nullptr},
 
     // Configure which overvoltage, overtemperature, and undertemperature diagnostics are enabled
-    sendBMSConfigCommand("DIAG_OV_OT_UT", "default");
+    {BMS_DIAG_OV_OT_UT, "default", nullptr},
 
     // Configure which undervoltage diagnostics are enabled
-    sendBMSConfigCommand("DIAG_UV", "default");
+    {BMS_DIAG_UV, "default", nullptr},
 
     // Configure which current diagnostics are enabled
-    sendBMSConfigCommand("DIAG_CURR", "default");
+    {BMS_DIAG_CURR, "default", nullptr},
 
     // Example: Send identity commands (replace 0x1234 with your actual data)
-    sendBMSIdentityCommand("MANUFACTURE_NAME_MSB", 0x1234);
-    sendBMSIdentityCommand("MANUFACTURE_NAME_LSB", 0x5678);
-    sendBMSIdentityCommand("MANUFACTURING_DATE", 0x2025);
-    sendBMSIdentityCommand("FIRST_USAGE_DATE", 0x2025);
-    sendBMSIdentityCommand("SERIAL_NUMBER_MSB", 0xABCD);
-    sendBMSIdentityCommand("SERIAL_NUMBER_LSB", 0xEF01);
-    sendBMSIdentityCommand("DEVICE_NAME_MSB", 0x1357);
-    sendBMSIdentityCommand("DEVICE_NAME_LSB", 0x2468);
-
-
-
-
-
-
-	// Set CSA gain factor (current sense amplifier gain)
-	// Range: 0x0000 (min) to 0xFFFF (max), default: 0x8000
-	sendBMSNumericalCommand("CSA_GAIN_FACTOR", "default", nullptr);
-
-	// Set cell overvoltage threshold and count
-	// Voltage: 0V (min) to 5.0V (max), default: 4.3V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VCELL_OV_TH", "max", "max");
-
-	// Set cell undervoltage threshold and count
-	// Voltage: 0V (min) to 5.0V (max), default: 2.2V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VCELL_UV_TH", "min", "max");
-
-	// Set cell severe delta thresholds (overvoltage, undervoltage)
-	// OV Delta: 0V (min) to 5.0V (max), default: 0.2V
-	// UV Delta: 0V (min) to 5.0V (max), default: 0.2V
-	sendBMSNumericalCommand("VCELL_SEVERE_DELTA_THRS", "max", "min");
-
-	// Set cell balancing undervoltage delta threshold and count
-	// Voltage: 0V (min) to 5.0V (max), default: 0.2V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VCELL_BAL_UV_DELTA_TH", "min", "max");
-
-	// Set battery block overvoltage threshold and count
-	// Voltage: 0V (min) to 25.0V (max), default: 23.0V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VB_OV_TH", "max", "max");
-
-	// Set battery block undervoltage threshold and count
-	// Voltage: 0V (min) to 25.0V (max), default: 10.93V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VB_UV_TH", "min", "max");
-
-	// Set battery block sum max difference threshold
-	// Voltage: 0V (min) to 25.0V (max), default: 2.0V
-	sendBMSNumericalCommand("VB_SUM_MAX_DIFF_TH", "max", nullptr);
-
-	// Set NTC (thermistor) overtemperature threshold and count
-	// Voltage: 0.2V (min) to 3.3V (max), default: 2.5V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VNTC_OT_TH", "max", "max");
-
-	// Set NTC (thermistor) undertemperature threshold and count
-	// Voltage: 0.0V (min) to 3.3V (max), default: 0.5V
-	// Count: 1 (min) to 15 (max), default: 15
-	sendBMSNumericalCommand("VNTC_UT_TH", "min", "max");
-
-	// Set NTC severe overtemperature delta threshold
-	// Voltage: 0.0V (min) to 3.3V (max), default: 0.5V
-	sendBMSNumericalCommand("VNTC_SEVERE_OT_DELTA_TH", "max", nullptr);
-
-	// Set overcurrent thresholds (charge, discharge)
-	// Current: 0A (min) to Imax (max, calculated), default: Imax
-	sendBMSNumericalCommand("OVC_THRESHOLDS", "max", "max");
-
-	// Set persistent overcurrent threshold
-	// Current: 0A (min) to Imax (max, calculated), default: Imax
-	sendBMSNumericalCommand("PERSISTENT_OVC_THRESHOLDS", "max", nullptr);
-
-	// Set short-circuit threshold and persistence threshold
-	// Current: ~6.1A (min, depends on senseResistor) to ~32.5A (max, depends on senseResistor), default: 100A
-	sendBMSNumericalCommand("SC_THRESHOLD", "max", "max");
-    
-
-
+    {BMS_MANUFACTURE_NAME_MSB, "0x1234", nullptr},
+    {BMS_MANUFACTURE_NAME_LSB, "0x5678", nullptr},
+    {BMS_MANUFACTURING_DATE, "0x2025", nullptr},
+    {BMS_FIRST_USAGE_DATE, "0x2025", nullptr},
+    {BMS_SERIAL_NUMBER_MSB, "0xABCD", nullptr},
+    {BMS_SERIAL_NUMBER_LSB, "0xEF01", nullptr},
+    {BMS_DEVICE_NAME_MSB, "0x1357", nullptr},
+    {BMS_DEVICE_NAME_LSB, "0x2468", nullptr},
+
+    // Protection thresholds. These were never written before, so they start at the datasheet defaults
+    // rather than the limits of their ranges: a 0V undervoltage threshold or a 5V cell overvoltage
+    // threshold would turn the protection off. Counts stay at 15, their default.
+    // CSA_GAIN_FACTOR is left out on purpose, the device holds its own factory trim there.
+
+    // Set cell overvoltage threshold and count
+    // Voltage: 0V (min) to 5.0V (max), default: 4.3V
+    {BMS_VCELL_OV_TH, "default", "max"},
+
+    // Set cell undervoltage threshold and count
+    // Voltage: 0V (min) to 5.0V (max), default: 2.2V
+    {BMS_VCELL_UV_TH, "default", "max"},
+
+    // Set cell severe delta thresholds (overvoltage, undervoltage)
+    // OV Delta: 0V (min) to 5.0V (max), default: 0.2V
+    // UV Delta: 0V (min) to 5.0V (max), default: 0.2V
+    {BMS_VCELL_SEVERE_DELTA_THRS, "default", "default"},
+
+    // Set cell balancing undervoltage delta threshold and count
+    // Voltage: 0V (min) to 5.0V (max), default: 0.2V
+    {BMS_VCELL_BAL_UV_DELTA_TH, "default", "max"},
+
+    // Set battery block overvoltage threshold and count
+    // Voltage: 0V (min) to 25.0V (max), default: 23.0V
+    {BMS_VB_OV_TH, "default", "max"},
+
+    // Set battery block undervoltage threshold and count
+    // Voltage: 0V (min) to 25.0V (max), default: 10.93V
+    {BMS_VB_UV_TH, "default", "max"},
+
+    // Set battery block sum max difference threshold
+    // Voltage: 0V (min) to 25.0V (max), default: 2.0V
+    {BMS_VB_SUM_MAX_DIFF_TH, "default", nullptr},
+
+    // Set NTC (thermistor) overtemperature threshold and count
+    // Voltage: 0.2V (min) to 3.3V (max), default: 2.5V
+    {BMS_VNTC_OT_TH, "default", "max"},
+
+    // Set NTC (thermistor) undertemperature threshold and count
+    // Voltage: 0.0V (min) to 3.3V (max), default: 0.5V
+    {BMS_VNTC_UT_TH, "default", "max"},
+
+    // Set NTC severe overtemperature delta threshold
+    // Voltage: 0.0V (min) to 3.3V (max), default: 0.5V
+    {BMS_VNTC_SEVERE_OT_DELTA_TH, "default", nullptr},
+
+    // Set overcurrent thresholds (charge, discharge)
+    // Current: 0A (min) to Imax (max, calculated), default: Imax
+    {BMS_OVC_THRESHOLDS, "default", "default"},
+
+    // Set persistent overcurrent threshold
+    // Current: 0A (min) to Imax (max, calculated), default: Imax
+    {BMS_PERSISTENT_OVC_THRESHOLDS, "default", nullptr},
+
+    // Set short-circuit threshold and persistence threshold
+    // Current: ~6.1A (min, depends on senseResistor) to ~32.5A (max, depends on senseResistor),
+    // the 100A default is clamped to the top of the range
+    {BMS_SC_THRESHOLD, "default", "default"},
+};
+
+bool getBMSConfigImage(BmsConfigImage& image) {
+    return buildBMSConfigImage(bmsConfiguration, sizeof(bmsConfiguration) / sizeof(bmsConfiguration[0]), image);
 }
 
+void SetUpBMS() {
 
+    BmsConfigImage image;
+    if (!getBMSConfigImage(image)) {
+        return;
+    }
+
+    // Load the NVM into the I2C registers, the full configuration is only written if it does not match
+    BmsFastBootResult boot = bmsFastBoot(image);
+    if (boot.loadedFromNvm) {
+        Serial.print("BMS loaded from NVM, fingerprint 0x");
+        Serial.print(boot.committedFingerprint, HEX);
+        Serial.print(" in ");
+        Serial.print(boot.durationMicros);
+        Serial.println(" us");
+        return;
+    }
+
+    BmsConfigResult result = boot.fallback;
+    Serial.print("BMS NVM did not match (");
+    Serial.print(boot.differing);
+    Serial.print(" registers differ");
+    if (!boot.identityValid) {
+        Serial.print(", identity blank");
+    }
+    if (!boot.committedFingerprintValid || boot.committedFingerprint != boot.expectedFingerprint) {
+        Serial.print(", not committed to NVM");
+    }
+    Serial.println("), configuring over I2C");
+    Serial.print("BMS configured: ");
+    Serial.print(result.differing);
+    Serial.print(" of ");
+    Serial.print(result.registers);
+    Serial.print(" registers written in ");
+    Serial.print(result.durationMicros);
+    Serial.println(" us");
+    if (!result.verified) {
+        Serial.print("Error: BMS configuration did not verify, ");
+        Serial.print(result.writeFailures);
+        Serial.print(" writes failed, ");
+        Serial.print(result.verifyFailures);
+        Serial.print(" registers differ, ");
+        Serial.println(I2C_StatusName(result.status));
+    }
+}
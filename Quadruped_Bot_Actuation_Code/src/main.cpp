@@ -21,9 +21,18 @@
 
 #include "I2C_FCT.h" // Include the I2C functions header file
 #include "I2C_MUX.h"    // Include the I2C multiplexer functions header file
+#include "I2C_Queue.h"  // Include the background I2C transaction queue header file
+#include "I2C_ClockProfiles.h" // Include the dual-bus clock profile and overlap functions
+#include "I2C_DeviceStats.h" // Include the per-device I2C statistics
+#include "I2C_Recovery.h" // Include the stuck bus recovery functions
 
 #include "SPI_NCDR_FCT.h" // Include the SPI NCDR functions header file
 #include "SPI_MUX.h" // Include the SPI multiplexer functions
+#include "NCDR_Acquisition.h" // Include the background encoder acquisition functions
+#include "NCDR_JointTracker.h" // Include the multi-turn joint tracker functions
+#include "NCDR_OffsetStore.h" // Include the encoder offset store functions
+#include "NCDR_Estimator.h" // Include the joint velocity and acceleration estimator functions
+#include "NCDR_Prediction.h" // Include the joint latency compensation functions
 
 #include "BMS_CoreCommands.h" // Include the BMS core commands header file
 #include "BMS_SetupCommands.h" // Include the BMS setup commands header file
@@ -31,8 +40,14 @@
 
 #include "BMS_ReadCommands.h" // Include the BMS read commands header file
 #include "SetUpBMS.h" // Include the BMS setup header file
+#include "BMS_Snapshot.h" // Include the RDY-driven BMS snapshot header file
+#include "BMS_Registers.h" // Include the BMS register descriptor table header file
+#include "BMS_NVM.h" // Include the BMS NVM fast boot and commit budget header file
 
 #include "MotorDriver_LP3943.h" // Include the motor driver LP3943 header file
+#include "MotorDriver_Shadow.h" // Include the motor driver shadow register header file
+#include "MotorDriver_Frame.h" // Include the batched motor command frame header file
+#include "MotorDriver_Registry.h" // Include the motor driver discovery and actuator map header file
 
 
 #include <Wire.h>
@@ -107,6 +122,8 @@ delay(1000); //delay for the control board to initialize
   Serial.begin(9600);
   Wire.begin(); //initialize the i2c bus
   Wire1.begin(); //initialize the i2c bus
+  I2C_QueueBegin(); //hand both i2c buses to the background transaction queue
+  I2C_RecoveryBegin(MOTOR_DRIVER_DEFAULT_ADDRESS); //recover locked up buses before retrying transfers
   
   while (!Serial)
      delay(10);
@@ -122,47 +139,26 @@ delay(1000); //delay for the control board to initialize
   delay(10);
   digitalWrite(NRESET, HIGH);
   delay(10);
+  I2C_MuxResetAll(); // the multiplexer is known to be at all channels off now
 
   I2C_DisableAllChannels(I2C_MUX_ADDRESS);
   
-  motorDriverInit(0,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(1,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(2,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(3,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(4,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(5,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(6,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-  
-  motorDriverInit(7,MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize the motor driver LP3943
-
-
-  resetEncoder(0);
-  resetEncoder(1);
-  resetEncoder(2);
-  resetEncoder(3);
-  resetEncoder(4);
-  resetEncoder(5);
-  resetEncoder(6);
-  resetEncoder(7);
-  resetEncoder(8);
-  resetEncoder(9);
-  resetEncoder(10);
-  resetEncoder(11);
-  resetEncoder(12);
-  resetEncoder(13);
-  resetEncoder(14);
-  resetEncoder(15);
-
-  SetUpBMS(); // Call the setup function for the BMS
-  attachInterrupt(digitalPinToInterrupt(RDY), onBMSReadyRise, RISING);
-
-  setBMSConversionState("CONVERSION_ON");  // To turn conversions ON
+  // Find every LP3943 on every channel and initialise them with one multicast per address
+  if (discoverMotorDrivers() > 0) {
+    initRegisteredDrivers();
+  } else {
+    Serial.println("Error: No motor drivers found, initialising the default address on every channel.");
+    motorDriverInitAll(I2C_MUX_ALL_CHANNELS, MOTOR_DRIVER_DEFAULT_ADDRESS); // Initialize all eight LP3943 motor drivers at once
+  }
+
+
+  // Load the encoder zero offsets, only re-zero the encoders when nothing valid is stored
+  if (!loadEncoderOffsets()) {
+    calibrateEncoders();
+  }
+
+  bmsSnapshotBegin(chipAddress); // read the measurement block on every RDY edge
+  SetUpBMS(); // Configure the BMS, this also turns conversions ON
 
   
   delay(100); // Wait for the multiplexer to switch channels
@@ -181,6 +177,9 @@ delay(1000); //delay for the control board to initialize
 
 void loop() {
 
+    I2C_ServiceRecovery(); // Free any bus a device has locked up since the last pass
+    serviceJointEstimators(); // Feed the joint estimators every new encoder sweep
+
     while (Serial.available() > 0) {
         char inChar = Serial.read();
         if (inChar == '\n' || inChar == '\r') {
@@ -191,23 +190,39 @@ void loop() {
 
             char cmd[16];
             int mux_channel, chip_address, speed, directionInt, speedOne, speedTwo, speedLevel;
+            long clockHz, periodMicros;
+            int iterations, busIndex;
 
             // "move" command
             if (sscanf(inputBuffer, "%s %d %d %d %d", cmd, &mux_channel, &chip_address, &speed, &directionInt) == 5 && strcmp(cmd, "move") == 0) {
                 bool direction = (directionInt != 0);
-                variableMotionControl(mux_channel, chip_address, speed, direction);
-                Serial.print("Moving motor on mux channel ");
-                Serial.print(mux_channel);
-                Serial.print(", chip address ");
-                Serial.print(chip_address, HEX);
-                Serial.print(", speed ");
-                Serial.print(speed);
-                Serial.print(", direction ");
-                Serial.println(direction ? "true" : "false");
+                bool accepted = true; // the frame refuses drivers it does not cover
+                if (motorFrameIsOpen()) {
+                    accepted = motorFrameMove(mux_channel, chip_address, speed, direction);
+                    if (accepted) {
+                        Serial.print("Frame: ");
+                    }
+                } else {
+                    variableMotionControl(mux_channel, chip_address, speed, direction);
+                }
+                if (accepted) {
+                    Serial.print("Moving motor on mux channel ");
+                    Serial.print(mux_channel);
+                    Serial.print(", chip address ");
+                    Serial.print(chip_address, HEX);
+                    Serial.print(", speed ");
+                    Serial.print(speed);
+                    Serial.print(", direction ");
+                    Serial.println(direction ? "true" : "false");
+                }
 
             // "stop" command
             } else if (sscanf(inputBuffer, "%s %d %d", cmd, &mux_channel, &chip_address) == 3 && strcmp(cmd, "stop") == 0) {
-                motorDriverStop(mux_channel, chip_address);
+                if (motorFrameIsOpen() && motorFrameStop(mux_channel, chip_address)) {
+                    Serial.print("Frame: ");
+                } else {
+                    motorDriverStop(mux_channel, chip_address); // a stop the frame refuses still goes out now
+                }
                 Serial.print("Stopped motor on mux channel ");
                 Serial.print(mux_channel);
                 Serial.print(", chip address ");
@@ -216,27 +231,312 @@ void loop() {
             // "defaultmove" command
             } else if (sscanf(inputBuffer, "%s %d %d %d %d", cmd, &mux_channel, &chip_address, &speedLevel, &directionInt) == 5 && strcmp(cmd, "defaultmove") == 0) {
                 bool direction = (directionInt != 0);
-                defaultMotionControl(mux_channel, chip_address, speedLevel, direction);
-                Serial.print("Default move on mux channel ");
-                Serial.print(mux_channel);
-                Serial.print(", chip address ");
-                Serial.print(chip_address, HEX);
-                Serial.print(", speed level ");
-                Serial.print(speedLevel);
-                Serial.print(", direction ");
-                Serial.println(direction ? "true" : "false");
+                bool accepted = true; // the frame refuses drivers it does not cover
+                if (motorFrameIsOpen()) {
+                    accepted = motorFrameDefaultMove(mux_channel, chip_address, speedLevel, direction);
+                    if (accepted) {
+                        Serial.print("Frame: ");
+                    }
+                } else {
+                    defaultMotionControl(mux_channel, chip_address, speedLevel, direction);
+                }
+                if (accepted) {
+                    Serial.print("Default move on mux channel ");
+                    Serial.print(mux_channel);
+                    Serial.print(", chip address ");
+                    Serial.print(chip_address, HEX);
+                    Serial.print(", speed level ");
+                    Serial.print(speedLevel);
+                    Serial.print(", direction ");
+                    Serial.println(direction ? "true" : "false");
+                }
 
             // "setspeeds" command
             } else if (sscanf(inputBuffer, "%s %d %d %d %d", cmd, &mux_channel, &chip_address, &speedOne, &speedTwo) == 5 && strcmp(cmd, "setspeeds") == 0) {
-                setMotionControl(mux_channel, chip_address, speedOne, speedTwo);
-                Serial.print("Set speeds on mux channel ");
-                Serial.print(mux_channel);
-                Serial.print(", chip address ");
-                Serial.print(chip_address, HEX);
-                Serial.print(", speedOne ");
-                Serial.print(speedOne);
-                Serial.print(", speedTwo ");
-                Serial.println(speedTwo);
+                bool accepted = true; // the frame refuses drivers it does not cover
+                if (motorFrameIsOpen()) {
+                    accepted = motorFrameSetSpeeds(mux_channel, chip_address, speedOne, speedTwo);
+                    if (accepted) {
+                        Serial.print("Frame: ");
+                    }
+                } else {
+                    setMotionControl(mux_channel, chip_address, speedOne, speedTwo);
+                }
+                if (accepted) {
+                    Serial.print("Set speeds on mux channel ");
+                    Serial.print(mux_channel);
+                    Serial.print(", chip address ");
+                    Serial.print(chip_address, HEX);
+                    Serial.print(", speedOne ");
+                    Serial.print(speedOne);
+                    Serial.print(", speedTwo ");
+                    Serial.println(speedTwo);
+                }
+
+            // "drivers" command, discovers the motor drivers on every channel and prints the actuator map
+            } else if (strcmp(inputBuffer, "drivers") == 0) {
+                uint8_t found = discoverMotorDrivers();
+                Serial.print(found);
+                Serial.print(" motor drivers, ");
+                Serial.print(getActuatorCount());
+                Serial.println(" actuators");
+                Actuator actuator;
+                for (uint8_t index = 0; getActuator(index, actuator); index++) {
+                    Serial.print("Actuator ");
+                    Serial.print(index);
+                    Serial.print(": channel ");
+                    Serial.print(actuator.mux_channel);
+                    Serial.print(", address 0x");
+                    Serial.print(actuator.address, HEX);
+                    Serial.print(", output ");
+                    Serial.println(actuator.output);
+                }
+
+            // "actuator" command, sets the speed of one actuator from the map, in the open frame if there is one
+            } else if (sscanf(inputBuffer, "%s %d %d", cmd, &iterations, &speed) == 3 && strcmp(cmd, "actuator") == 0) {
+                bool framed = motorFrameIsOpen();
+                if (setActuatorSpeed(iterations, speed)) {
+                    if (!framed) {
+                        motorFrameCommit();
+                    }
+                    Serial.print(framed ? "Frame: actuator " : "Actuator ");
+                    Serial.print(iterations);
+                    Serial.print(" speed ");
+                    Serial.println(speed);
+                }
+
+            // "registrybench" command, runs 64 simulated drivers one at a time against the grouped schedule on a dry run bus
+            } else if (sscanf(inputBuffer, "%s %ld", cmd, &clockHz) == 2 && strcmp(cmd, "registrybench") == 0) {
+                RegistryBenchmark result = benchmarkRegistryScaling(clockHz);
+                Serial.print("Simulated ");
+                Serial.print(result.drivers);
+                Serial.print(" drivers, ");
+                Serial.print(result.actuators);
+                Serial.print(" actuators, map built in ");
+                Serial.print(result.mapMicros);
+                Serial.println(" us");
+                Serial.print("Init transactions, one driver at a time: ");
+                Serial.print(result.perDriverInitTransactions);
+                Serial.print(", multicast per address: ");
+                Serial.println(result.groupedInitTransactions);
+                Serial.print("Full frame, one driver at a time: ");
+                Serial.print(result.perDriverFrameSwitches);
+                Serial.print(" switches, ");
+                Serial.print(result.perDriverFrameTransactions);
+                Serial.print(" transactions, ");
+                Serial.print(result.perDriverFrameMicros);
+                Serial.println(" us");
+                Serial.print("Full frame, grouped by channel: ");
+                Serial.print(result.groupedFrameSwitches);
+                Serial.print(" switches, ");
+                Serial.print(result.groupedFrameTransactions);
+                Serial.print(" transactions, ");
+                Serial.print(result.groupedFrameMicros);
+                Serial.println(" us");
+
+            // "framebegin" command, collects the following move, stop, defaultmove and setspeeds commands into one frame
+            } else if (strcmp(inputBuffer, "framebegin") == 0) {
+                motorFrameBegin();
+                Serial.println("Motor frame open.");
+
+            // "framecommit" command, writes the frame in channel order and waits for it to land
+            } else if (strcmp(inputBuffer, "framecommit") == 0) {
+                MotorFrameResult result = motorFrameCommit(true);
+                Serial.print("Frame committed: ");
+                Serial.print(result.drivers);
+                Serial.print(" drivers, ");
+                Serial.print(result.bursts);
+                Serial.print(" bursts, ");
+                Serial.print(result.channelSwitches);
+                Serial.print(" channel switches, queued in ");
+                Serial.print(result.queueMicros);
+                Serial.print(" us, landed in ");
+                Serial.print(result.landMicros);
+                Serial.println(" us");
+
+            // "framesync" command, commits the frame in two phases so the drivers switch outputs together, and prints the skew
+            } else if (strcmp(inputBuffer, "framesync") == 0) {
+                MotorSyncResult result = motorFrameCommitSynchronous();
+                Serial.print("Frame committed: ");
+                Serial.print(result.drivers);
+                Serial.print(" drivers, ");
+                Serial.print(result.stageBursts);
+                Serial.print(" staged bursts (");
+                Serial.print(result.stageFailures);
+                Serial.print(" drivers failed) in ");
+                Serial.print(result.stageMicros);
+                Serial.print(" us, ");
+                Serial.print(result.switchWrites);
+                Serial.print(" output switch writes (");
+                Serial.print(result.switchFailures);
+                Serial.print(" failed, ");
+                Serial.print(result.switchMismatches);
+                Serial.print(" drivers missed), ");
+                Serial.print(result.runningDutyWrites);
+                Serial.print(" duty writes to running outputs, skew ");
+                Serial.print(result.skewMicros);
+                Serial.print(" us, landed in ");
+                Serial.print(result.landMicros);
+                Serial.println(" us");
+                MotorSkewStats skew = getMotorSkewStats();
+                Serial.print("Skew over ");
+                Serial.print(skew.frames);
+                Serial.print(" frames, mean/max: ");
+                Serial.print(skew.meanSkew);
+                Serial.print("/");
+                Serial.print(skew.maxSkew);
+                Serial.println(" us");
+
+            // "frameabort" command, drops the open frame
+            } else if (strcmp(inputBuffer, "frameabort") == 0) {
+                motorFrameAbort();
+                Serial.println("Motor frame dropped.");
+
+            // "estop" command, stops every motor with one multicast write per driver address
+            } else if (strcmp(inputBuffer, "estop") == 0) {
+                motorFrameAbort(); // nothing staged before the stop may go out after it
+                uint32_t latency = stopRegisteredDrivers();
+                Serial.print("All motors stopped in ");
+                Serial.print(latency);
+                Serial.println(" us");
+
+            // "estopbench" command, compares a single stop per driver with the multicast stop
+            } else if (strcmp(inputBuffer, "estopbench") == 0) {
+                MotorStopBenchmark result = benchmarkRegisteredStop();
+                Serial.print("Sequential stop: ");
+                Serial.print(result.sequentialLatency);
+                Serial.print(" us, multicast stop: ");
+                Serial.print(result.multicastLatency);
+                Serial.println(" us");
+
+            // "i2cclock" command, sets the clock profile of a bus (0 = Wire, 1 = Wire1) in Hz
+            } else if (sscanf(inputBuffer, "%s %d %ld", cmd, &busIndex, &clockHz) == 3 && strcmp(cmd, "i2cclock") == 0) {
+                if (I2C_SetClockProfile(busIndex, clockHz)) {
+                    Serial.print("I2C bus ");
+                    Serial.print(busIndex);
+                    Serial.print(" clock: ");
+                    Serial.print(I2C_GetClockProfile(busIndex));
+                    Serial.println(" Hz");
+                }
+
+            // "i2cstats" command, prints the activity counters of both buses and every device, then resets them
+            } else if (strcmp(inputBuffer, "i2cstats") == 0) {
+                for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+                    I2C_BusStats stats = I2C_GetBusStats(bus);
+                    Serial.print(bus == I2C_BUS_WIRE ? "Wire: " : "Wire1: ");
+                    Serial.print(stats.jobsCompleted);
+                    Serial.print(" jobs, ");
+                    Serial.print(stats.jobsFailed);
+                    Serial.print(" failed, utilisation ");
+                    Serial.print(stats.utilisation * 100.0f, 1);
+                    Serial.print("%, queue depth ");
+                    Serial.print(stats.queueDepth);
+                    Serial.print(" (max ");
+                    Serial.print(stats.maxQueueDepth);
+                    Serial.println(")");
+                    I2C_ResetBusStats(bus);
+                }
+                I2C_DeviceStats device;
+                for (uint8_t index = 0; I2C_GetDeviceStats(index, device); index++) {
+                    Serial.print(device.bus == I2C_BUS_WIRE ? "Wire 0x" : "Wire1 0x");
+                    Serial.print(device.address, HEX);
+                    Serial.print(" mux 0b");
+                    Serial.print(device.muxMask, BIN);
+                    Serial.print(": ");
+                    Serial.print(device.transactions);
+                    Serial.print(" transactions, ");
+                    Serial.print(device.errors);
+                    Serial.print(" errors (");
+                    Serial.print(device.timeouts);
+                    Serial.print(" timeouts), latency min/mean/max ");
+                    Serial.print(device.minLatency);
+                    Serial.print("/");
+                    Serial.print(device.meanLatency);
+                    Serial.print("/");
+                    Serial.print(device.maxLatency);
+                    Serial.print(" us, histogram");
+                    for (uint8_t bucket = 0; bucket < I2C_LATENCY_BUCKETS; bucket++) {
+                        Serial.print(bucket == 0 ? " " : "/");
+                        Serial.print(device.histogram[bucket]);
+                    }
+                    Serial.println();
+                }
+                Serial.print("Histogram buckets: <");
+                for (uint8_t bucket = 0; bucket < I2C_LATENCY_BUCKETS - 1; bucket++) {
+                    Serial.print(I2C_GetLatencyBucketLimit(bucket));
+                    Serial.print(bucket < I2C_LATENCY_BUCKETS - 2 ? "/<" : " us, rest above\n");
+                }
+                if (I2C_GetDroppedDeviceRecords() > 0) {
+                    Serial.print("Error: Device table full, ");
+                    Serial.print(I2C_GetDroppedDeviceRecords());
+                    Serial.println(" transactions not recorded.");
+                }
+                I2C_ResetDeviceStats();
+
+            // "shadowstats" command, prints how many motor driver register writes the shadow dropped, then resets the counters
+            } else if (strcmp(inputBuffer, "shadowstats") == 0) {
+                ShadowStats stats = getShadowStats();
+                uint32_t staged = stats.hits + stats.misses;
+                Serial.print("Shadow registers: ");
+                Serial.print(stats.hits);
+                Serial.print(" writes dropped, ");
+                Serial.print(stats.misses);
+                Serial.print(" written (");
+                Serial.print(staged > 0 ? 100.0f * stats.hits / staged : 0.0f, 1);
+                Serial.print("% hit rate) in ");
+                Serial.print(stats.transactions);
+                Serial.print(" bursts, ");
+                Serial.print(stats.bridged);
+                Serial.println(" clean registers bridged");
+                resetShadowStats();
+
+            // "overlapbench" command, compares BMS and motor driver reads run one bus at a time and on both buses at once
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &iterations) == 2 && strcmp(cmd, "overlapbench") == 0) {
+                I2C_OverlapBenchmark result = benchmarkBusOverlap(iterations, chipAddress, MOTOR_DRIVER_DEFAULT_ADDRESS);
+                Serial.print("One bus at a time: ");
+                Serial.print(result.serialMicros);
+                Serial.print(" us, both buses at once: ");
+                Serial.print(result.concurrentMicros);
+                Serial.println(" us");
+
+            // "i2crecover" command, runs the stuck bus recovery on a bus (0 = Wire, 1 = Wire1)
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &busIndex) == 2 && strcmp(cmd, "i2crecover") == 0) {
+                I2C_RecoveryResult result = I2C_RecoverBus(busIndex);
+                Serial.print("I2C bus ");
+                Serial.print(busIndex);
+                Serial.print(result.released ? " released after " : " still held low after ");
+                Serial.print(result.clockPulses);
+                Serial.print(" clock pulses, re-initialisation ");
+                Serial.print(I2C_StatusName(result.reinitStatus));
+                Serial.print(", ");
+                Serial.print(result.driversRestored);
+                Serial.print(" drivers restored, ");
+                Serial.print(result.durationMicros);
+                Serial.println(" us");
+
+            // "i2crecovertest" command, simulates a device holding SDA low for a number of clock pulses and recovers from it
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &iterations) == 2 && strcmp(cmd, "i2crecovertest") == 0) {
+                I2C_RecoveryTest test = I2C_TestRecovery(iterations);
+                Serial.print("Recovered in ");
+                Serial.print(test.recovery.durationMicros);
+                Serial.print(" us after ");
+                Serial.print(test.recovery.clockPulses);
+                Serial.print(" clock pulses, multiplexer ");
+                Serial.print(test.muxRestored ? "restored" : "NOT restored");
+                Serial.print(", first driver write ");
+                Serial.print(I2C_StatusName(test.resumeStatus));
+                Serial.print(" ");
+                Serial.print(test.resumeMicros);
+                Serial.print(" us after detection, ");
+                Serial.println(test.passed ? "pass" : "FAIL");
+                I2C_RecoveryStats stats = I2C_GetRecoveryStats(I2C_BUS_WIRE);
+                Serial.print("Wire recoveries: ");
+                Serial.print(stats.recoveries);
+                Serial.print(", failures: ");
+                Serial.print(stats.failures);
+                Serial.print(", longest: ");
+                Serial.print(stats.maxMicros);
+                Serial.println(" us");
 
             } else if (strcmp(inputBuffer, "abc") == 0) {
                 Serial.println("Running test for 'abc'!");
@@ -261,17 +561,372 @@ void loop() {
                 Serial.println("Running test C...");
                 // ...test C code...
 
-                float current = readCurrentEstimate(7, MOTOR_DRIVER_DEFAULT_ADDRESS);
-                Serial.print("Current estimate: ");
-                Serial.print(current, 4); // Print with 4 decimal places
-                Serial.println(" A");
+                I2C_Status readStatus;
+                float current = readCurrentEstimate(7, MOTOR_DRIVER_DEFAULT_ADDRESS, &readStatus);
+                if (readStatus != I2C_OK) {
+                    Serial.print("Error: current read failed, ");
+                    Serial.println(I2C_StatusName(readStatus));
+                } else {
+                    Serial.print("Current estimate: ");
+                    Serial.print(current, 4); // Print with 4 decimal places
+                    Serial.println(" A");
+                }
 
             } else if (strcmp(inputBuffer, "d") == 0) {
                 Serial.println("Running test D...");
                 // Read limit triggers from mux channel 7 and default address
-                uint8_t limits = readLimitTriggers(7, MOTOR_DRIVER_DEFAULT_ADDRESS);
-                Serial.print("Limit triggers: 0b");
-                Serial.println(limits, BIN); // Print as binaryelse {
+                I2C_Status readStatus;
+                uint8_t limits = readLimitTriggers(7, MOTOR_DRIVER_DEFAULT_ADDRESS, &readStatus);
+                if (readStatus != I2C_OK) {
+                    Serial.print("Error: limit trigger read failed, ");
+                    Serial.println(I2C_StatusName(readStatus));
+                } else {
+                    Serial.print("Limit triggers: 0b");
+                    Serial.println(limits, BIN); // Print as binary
+                }
+
+            // "status" command, reads the limit switches and current of one driver in a single burst
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &mux_channel) == 2 && strcmp(cmd, "status") == 0) {
+                MotorDriverStatus status = readDriverStatus(mux_channel, MOTOR_DRIVER_DEFAULT_ADDRESS);
+                if (status.status == I2C_OK) {
+                    Serial.print("Limit triggers: 0b");
+                    Serial.print(status.limitTriggers, BIN);
+                    Serial.print(", current estimate: ");
+                    Serial.print(driverCurrentFromCode(status.currentCode), 4);
+                    Serial.println(" A");
+                } else {
+                    Serial.print("Error: Driver status read failed, ");
+                    Serial.println(I2C_StatusName(status.status));
+                }
+
+            // "statusall" command, reads the status of every driver in one pass
+            } else if (strcmp(inputBuffer, "statusall") == 0) {
+                MotorDriverStatus statuses[MOTOR_DRIVER_CHANNEL_COUNT];
+                readAllDriverStatus(MOTOR_DRIVER_DEFAULT_ADDRESS, statuses);
+                for (uint8_t channel = 0; channel < MOTOR_DRIVER_CHANNEL_COUNT; channel++) {
+                    Serial.print("Channel ");
+                    Serial.print(channel);
+                    if (statuses[channel].status == I2C_OK) {
+                        Serial.print(": limits 0b");
+                        Serial.print(statuses[channel].limitTriggers, BIN);
+                        Serial.print(", current ");
+                        Serial.print(driverCurrentFromCode(statuses[channel].currentCode), 4);
+                        Serial.println(" A");
+                    } else {
+                        Serial.print(": ");
+                        Serial.println(I2C_StatusName(statuses[channel].status));
+                    }
+                }
+
+            // "statusbench" command, compares separate limit and current reads with the burst sweep
+            } else if (strcmp(inputBuffer, "statusbench") == 0) {
+                MotorStatusBenchmark result = benchmarkDriverStatus(MOTOR_DRIVER_DEFAULT_ADDRESS);
+                Serial.print("Separate reads: ");
+                Serial.print(result.separateJobs);
+                Serial.print(" bus jobs, ");
+                Serial.print(result.separateMicros);
+                Serial.print(" us, burst sweep: ");
+                Serial.print(result.sweepJobs);
+                Serial.print(" bus jobs, ");
+                Serial.print(result.sweepMicros);
+                Serial.println(" us");
+
+            // "spiclock" command, sets the encoder SPI clock in Hz
+            } else if (sscanf(inputBuffer, "%s %ld", cmd, &clockHz) == 2 && strcmp(cmd, "spiclock") == 0) {
+                setEncoderSPIClock(clockHz);
+                Serial.print("Encoder SPI clock: ");
+                Serial.print(getEncoderSPIClock());
+                Serial.println(" Hz");
+
+            // "sweep" command, reads all encoders and compares the sweep time against the timing model
+            } else if (strcmp(inputBuffer, "sweep") == 0 && isEncoderAcquisitionRunning()) {
+                Serial.println("Stop encoder acquisition before running a blocking sweep.");
+
+            } else if (strcmp(inputBuffer, "sweep") == 0) {
+                EncoderSnapshot snapshot = readAllEncoders();
+                for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+                    Serial.print("Encoder ");
+                    Serial.print(channel);
+                    Serial.print(": ");
+                    Serial.print(angleToDegrees(snapshot.samples[channel].angle), 2);
+                    Serial.print(" deg at ");
+                    Serial.print(snapshot.samples[channel].timestamp - snapshot.sweepStart);
+                    Serial.println(" us");
+                }
+                Serial.print("Sweep time: ");
+                Serial.print(snapshot.sweepDuration);
+                Serial.print(" us, model: ");
+                Serial.print(ncdrSweepNs(getEncoderSPIClock(), NCDR_CHANNEL_COUNT) / 1000);
+                Serial.print(" us, budget: ");
+                Serial.print(NCDR_SWEEP_BUDGET_US);
+                Serial.println(" us");
+
+            // "sweepbench" command, compares the pipelined and serial sweeps and reports intra-leg skew
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &iterations) == 2 && strcmp(cmd, "sweepbench") == 0 && !isEncoderAcquisitionRunning()) {
+                EncoderSweepBenchmark result = benchmarkEncoderSweep(iterations);
+                Serial.print("Pipelined sweep mean: ");
+                Serial.print(result.meanSweep);
+                Serial.print(" us, max: ");
+                Serial.print(result.maxSweep);
+                Serial.print(" us, serial sweep mean: ");
+                Serial.print(result.meanSerialSweep);
+                Serial.println(" us");
+                Serial.print("Worst intra-leg skew: ");
+                Serial.print(result.worstPairSkew);
+                Serial.print(" us on leg ");
+                Serial.println(result.worstPairLeg);
+
+            // "joints" command, updates the multi-turn trackers from the latest sweep and prints them
+            } else if (strcmp(inputBuffer, "joints") == 0) {
+                EncoderSnapshot snapshot;
+                if (isEncoderAcquisitionRunning()) {
+                    if (!getLatestEncoderSnapshot(snapshot)) {
+                        Serial.println("No encoder snapshot available.");
+                        snapshot.sequence = 0;
+                    }
+                } else {
+                    snapshot = readAllEncoders();
+                }
+                if (snapshot.sequence != 0) {
+                    updateJointTrackers(snapshot);
+                    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+                        Serial.print("Joint ");
+                        Serial.print(channel);
+                        Serial.print(": ");
+                        Serial.print(getJointCounts(channel));
+                        Serial.print(" counts, ");
+                        Serial.println(getJointPosition(channel), 2);
+                    }
+                }
+
+            // "rates" command, prints the joint estimator state fed by the background encoder sweeps
+            } else if (strcmp(inputBuffer, "rates") == 0) {
+                if (!isEncoderAcquisitionRunning()) {
+                    Serial.println("Error: Encoder acquisition is not running, the joint estimators are not being fed.");
+                }
+                for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+                    JointState state = getJointState(channel);
+                    Serial.print("Joint ");
+                    Serial.print(channel);
+                    Serial.print(": ");
+                    if (!state.valid) {
+                        Serial.println("no estimate");
+                        continue;
+                    }
+                    Serial.print(state.position * 360.0f, 2);
+                    Serial.print(" deg, ");
+                    Serial.print(state.velocity * 360.0f, 2);
+                    Serial.print(" deg/s, ");
+                    Serial.print(state.acceleration * 360.0f, 1);
+                    Serial.println(" deg/s^2");
+                }
+
+            // "esttest" command, replays recorded sample streams through the estimator and checks the errors
+            } else if (strcmp(inputBuffer, "esttest") == 0) {
+                Serial.println(selfTestJointEstimator() ? "Estimator self test passed." : "Estimator self test FAILED.");
+
+            // "predict" command, sets both motor speeds of a leg and prints the joint angles the estimators
+            // predict for when the PWM writes land
+            } else if (sscanf(inputBuffer, "%s %d %d %d", cmd, &mux_channel, &speedOne, &speedTwo) == 4 && strcmp(cmd, "predict") == 0) {
+                uint8_t firstJoint = mux_channel * NCDR_JOINTS_PER_LEG;
+                if (mux_channel < 0 || firstJoint >= NCDR_CHANNEL_COUNT) {
+                    Serial.println("Error: No joints on that mux channel.");
+                } else if (!isEncoderAcquisitionRunning() || !getJointState(firstJoint).valid) {
+                    Serial.println("Error: Encoder acquisition is not running, no joint estimate to predict from.");
+                } else {
+                    serviceJointEstimators(); // make sure the latest sweep is in
+                    JointState sampled[NCDR_JOINTS_PER_LEG];
+                    JointState predicted[NCDR_JOINTS_PER_LEG];
+                    for (uint8_t n = 0; n < NCDR_JOINTS_PER_LEG; n++) {
+                        sampled[n] = getJointState(firstJoint + n);
+                        predicted[n] = predictJointAtActuation(firstJoint + n);
+                    }
+                    setMotionControl(mux_channel, MOTOR_DRIVER_DEFAULT_ADDRESS, speedOne, speedTwo);
+                    I2C_WaitIdle(I2C_BUS_WIRE); // the PWM writes are queued, wait for them to land
+                    for (uint8_t n = 0; n < NCDR_JOINTS_PER_LEG; n++) {
+                        recordJointActuation(firstJoint + n);
+                        Serial.print("Joint ");
+                        Serial.print(firstJoint + n);
+                        Serial.print(": estimated ");
+                        Serial.print(sampled[n].position * 360.0f, 2);
+                        Serial.print(" deg at ");
+                        Serial.print(sampled[n].velocity * 360.0f, 2);
+                        Serial.print(" deg/s, predicted at actuation ");
+                        Serial.print(predicted[n].position * 360.0f, 2);
+                        Serial.println(" deg");
+                    }
+                }
+
+            // "latency" command, prints the sense-to-actuate latency of every joint
+            } else if (strcmp(inputBuffer, "latency") == 0) {
+                for (uint8_t joint = 0; joint < NCDR_CHANNEL_COUNT; joint++) {
+                    JointLatencyStats stats = getJointLatencyStats(joint);
+                    Serial.print("Joint ");
+                    Serial.print(joint);
+                    Serial.print(": ");
+                    Serial.print(stats.commands);
+                    Serial.print(" commands, latency min/mean/max ");
+                    Serial.print(stats.minLatency);
+                    Serial.print("/");
+                    Serial.print(stats.meanLatency);
+                    Serial.print("/");
+                    Serial.print(stats.maxLatency);
+                    Serial.print(" us, landing error ");
+                    Serial.print(stats.meanLandingError);
+                    Serial.println(" us");
+                }
+
+            // "syncturns" command, resyncs every joint tracker from the encoder turns counters
+            } else if (strcmp(inputBuffer, "syncturns") == 0 && !isEncoderAcquisitionRunning()) {
+                for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+                    syncJointTurns(channel);
+                }
+                Serial.println("Joint turns resynced.");
+
+            // "anglebench" command, compares the float degrees and fixed-point angle paths per sample
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &iterations) == 2 && strcmp(cmd, "anglebench") == 0) {
+                AnglePathBenchmark result = benchmarkAnglePaths(iterations);
+                Serial.print("Float path: ");
+                Serial.print(result.floatCyclesPerSample, 1);
+                Serial.print(" cycles/sample, fixed-point path: ");
+                Serial.print(result.fixedCyclesPerSample, 1);
+                Serial.println(" cycles/sample");
+
+            // "calibrate" command, reboots all encoders, takes new zero offsets and saves them
+            } else if (strcmp(inputBuffer, "calibrate") == 0 && !isEncoderAcquisitionRunning()) {
+                calibrateEncoders();
+
+            // "acqstart" command, starts background encoder acquisition with a period in microseconds
+            } else if (sscanf(inputBuffer, "%s %ld", cmd, &periodMicros) == 2 && strcmp(cmd, "acqstart") == 0) {
+                startEncoderAcquisition(periodMicros);
+                Serial.println(isEncoderAcquisitionRunning() ? "Encoder acquisition running." : "Encoder acquisition not started.");
+
+            } else if (strcmp(inputBuffer, "acqstop") == 0) {
+                stopEncoderAcquisition();
+                Serial.println("Encoder acquisition stopped.");
+
+            // "acq" command, prints the latest background snapshot
+            } else if (strcmp(inputBuffer, "acq") == 0) {
+                EncoderSnapshot snapshot;
+                if (getLatestEncoderSnapshot(snapshot)) {
+                    for (uint8_t channel = 0; channel < NCDR_CHANNEL_COUNT; channel++) {
+                        Serial.print("Encoder ");
+                        Serial.print(channel);
+                        Serial.print(": ");
+                        Serial.print(angleToDegrees(snapshot.samples[channel].angle), 2);
+                        Serial.println(" deg");
+                    }
+                    Serial.print("Sequence: ");
+                    Serial.print(snapshot.sequence);
+                    Serial.print(", sweep time: ");
+                    Serial.print(snapshot.sweepDuration);
+                    Serial.print(" us, age: ");
+                    Serial.print(getEncoderSnapshotAge());
+                    Serial.print(" us, overruns: ");
+                    Serial.println(getEncoderAcquisitionOverruns());
+                } else {
+                    Serial.println("No encoder snapshot available.");
+                }
+
+            // "bmsbench" command, compares the separate BMS read functions against a block read of the same registers
+            } else if (sscanf(inputBuffer, "%s %d", cmd, &iterations) == 2 && strcmp(cmd, "bmsbench") == 0) {
+                BmsBlockBenchmark result = benchmarkBMSBlockRead(chipAddress, iterations);
+                Serial.print("Separate reads: ");
+                Serial.print(result.separateMicros);
+                Serial.print(" us in ");
+                Serial.print(result.separateTransactions);
+                Serial.print(" transactions, block read: ");
+                Serial.print(result.blockMicros);
+                Serial.print(" us in ");
+                Serial.print(result.blockTransactions);
+                Serial.print(" transactions, decode: ");
+                Serial.print(result.decodeMicros);
+                Serial.println(" us");
+
+            // "bmsenctest" command, checks the register table encodings against the recorded strcmp-based ones
+            } else if (strcmp(inputBuffer, "bmsenctest") == 0) {
+                BmsEncodingTest result = testBMSRegisterEncodings();
+                Serial.print("BMS encodings: ");
+                Serial.print(result.cases);
+                Serial.print(" cases, ");
+                Serial.print(result.mismatches);
+                Serial.print(" mismatches");
+                if (result.firstMismatch >= 0) {
+                    Serial.print(", first at case ");
+                    Serial.print(result.firstMismatch);
+                }
+                Serial.println(result.passed ? ", passed" : ", FAILED");
+
+            // "bmsnvm" command, prints the NVM commits left and the fingerprint of the last one
+            } else if (strcmp(inputBuffer, "bmsnvm") == 0) {
+                Serial.print("BMS NVM commits remaining: ");
+                Serial.print(getBMSNvmCommitsRemaining());
+                Serial.print(" of ");
+                Serial.print(BMS_NVM_COMMIT_LIMIT);
+                uint16_t fingerprint;
+                if (getBMSNvmFingerprint(fingerprint)) {
+                    Serial.print(", committed fingerprint: 0x");
+                    Serial.println(fingerprint, HEX);
+                } else {
+                    Serial.println(", committed fingerprint: unknown");
+                }
+
+            // "bmsnvmcommit" command, commits the startup configuration to the BMS NVM. Uses one of the 32 commits!
+            } else if (strcmp(inputBuffer, "bmsnvmcommit") == 0) {
+                BmsConfigImage image;
+                if (getBMSConfigImage(image) && commitBMSConfigToNVM(image)) {
+                    Serial.print("BMS NVM commits remaining: ");
+                    Serial.println(getBMSNvmCommitsRemaining());
+                }
+
+            // "bms" command, prints the latest BMS snapshot without touching the bus, then the acquisition counters
+            } else if (strcmp(inputBuffer, "bms") == 0) {
+                BmsSnapshot snapshot;
+                if (getBMSSnapshot(snapshot)) {
+                    for (uint8_t cell = 0; cell < BMS_CELL_COUNT; cell++) {
+                        Serial.print("Cell ");
+                        Serial.print(cell + 1);
+                        Serial.print(": ");
+                        Serial.print(snapshot.measurements.cellVoltage[cell], 3);
+                        Serial.println(" V");
+                    }
+                    Serial.print("Sum: ");
+                    Serial.print(snapshot.measurements.cellSum, 3);
+                    Serial.print(" V, VB: ");
+                    Serial.print(snapshot.measurements.batteryVoltage, 3);
+                    Serial.print(" V, NTC: ");
+                    Serial.print(snapshot.measurements.ntcVoltage, 3);
+                    Serial.print(" V, die: ");
+                    Serial.print(snapshot.measurements.dieTemperature, 1);
+                    Serial.print(" C, current: ");
+                    Serial.print(snapshot.measurements.current, 3);
+                    Serial.println(" A");
+                    Serial.print("Sequence: ");
+                    Serial.print(snapshot.sequence);
+                    Serial.print(", read in ");
+                    Serial.print(snapshot.readMicros);
+                    Serial.print(" us of ");
+                    Serial.print(validWindow);
+                    Serial.print(" us window, age: ");
+                    Serial.print(getBMSSnapshotAge());
+                    Serial.println(snapshot.inWindow ? " us" : " us, MISSED WINDOW");
+                } else {
+                    Serial.println("No BMS snapshot available.");
+                }
+                BmsSnapshotStats stats = getBMSSnapshotStats();
+                Serial.print("Snapshots: ");
+                Serial.print(stats.published);
+                Serial.print(" published, ");
+                Serial.print(stats.missedWindow);
+                Serial.print(" missed the window, ");
+                Serial.print(stats.failed);
+                Serial.print(" failed, read time last/max ");
+                Serial.print(stats.lastReadMicros);
+                Serial.print("/");
+                Serial.print(stats.maxReadMicros);
+                Serial.println(" us");
+
+            } else {
                 Serial.println("Unknown command.");
             }
 